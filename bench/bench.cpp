@@ -0,0 +1,234 @@
+// Standalone benchmarks of the native network kernels, on synthetic networks,
+// without R. See the Makefile in this directory for usage.
+
+#include "generate.h"
+
+#include "cycles.h"
+#include "edge_map.h"
+#include "face_update.h"
+#include "faces.h"
+#include "preprocess.h"
+#include "reduce_paths.h"
+#include "stats.h"
+#include "utils.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+
+// Peak resident set size of the process in megabytes.
+double peak_rss_mb ()
+{
+    struct rusage usage;
+    getrusage (RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return static_cast <double> (usage.ru_maxrss) / 1048576.0; // bytes
+#else
+    return static_cast <double> (usage.ru_maxrss) / 1024.0; // kilobytes
+#endif
+}
+
+// Time one stage, and report throughput in millions of network edges per
+// second.
+template <typename F>
+void time_stage (const char *layout, const size_t n_edges, const char *stage,
+        F f)
+{
+    const auto t0 = std::chrono::steady_clock::now ();
+    f ();
+    const auto t1 = std::chrono::steady_clock::now ();
+    const double secs = std::chrono::duration <double> (t1 - t0).count ();
+    std::printf ("%-10s %10zu  %-14s %10.4f %10.3f %10.1f\n", layout, n_edges,
+            stage, secs, static_cast <double> (n_edges) / secs / 1.0e6,
+            peak_rss_mb ());
+    std::fflush (stdout);
+}
+
+// Work counters of the preceding stage, as a single comment line.
+void print_counters ()
+{
+    std::printf ("#");
+    for (size_t i = 0; i < stats::N_COUNTERS; i++)
+        std::printf (" %s=%llu", stats::counter_names [i],
+                static_cast <unsigned long long> (stats::counters [i].load ()));
+    std::printf ("\n");
+}
+
+void run (const Layout layout, const char *layout_name, const size_t n_target,
+        const int nthreads, const unsigned seed)
+{
+    SynthNetwork synth;
+    generate::network (synth, layout, n_target, seed);
+    const size_t n = synth.v0.size ();
+
+    // Terminal edges are peeled from undirected edges, as in the R function
+    // 'preprocess_network':
+    time_stage (layout_name, n, "preprocess", [&] () {
+        std::vector <index_t> u0, u1;
+        for (size_t i = 0; i < n; i += 2)
+        {
+            u0.push_back (synth.v0 [i]);
+            u1.push_back (synth.v1 [i]);
+        }
+        std::vector <bool> can_be_terminal (synth.n_verts, true);
+        std::vector <bool> keep (u0.size (), true);
+        preprocess::peel_terminal (u0, u1, can_be_terminal, keep);
+    });
+
+    NetworkColumns cols;
+    generate::columns (synth, cols);
+    Network network;
+    time_stage (layout_name, n, "fill_network", [&] () {
+        build_network::fill_network (network, cols);
+    });
+
+    time_stage (layout_name, n, "fill_rotation", [&] () {
+        build_network::fill_rotation (network);
+    });
+
+    std::vector <std::vector <index_t> > paths_left, paths_right;
+    std::vector <CycleKey> keys_left, keys_right;
+    stats::reset ();
+    time_stage (layout_name, n, "trace", [&] () {
+        std::vector <index_t> start (n);
+        std::iota (start.begin (), start.end (), 0);
+        cycles::trace_left_right (network, start, paths_left, paths_right,
+                keys_left, keys_right, nthreads);
+    });
+    print_counters ();
+
+    // Paths are reduced in order of increasing size, as in 'cpp_reduce_paths':
+    std::vector <std::vector <index_t> > paths (paths_left);
+    paths.insert (paths.end (), paths_right.begin (), paths_right.end ());
+    time_stage (layout_name, n, "reduce_paths", [&] () {
+        std::vector <size_t> n_edges (paths.size ());
+        for (size_t i = 0; i < paths.size (); i++)
+            n_edges [i] = paths [i].size ();
+        std::vector <size_t> sorted = utils::sort_indexes <size_t> (n_edges);
+        std::vector <std::vector <int> > edge_sets (paths.size ());
+        for (size_t i = 0; i < paths.size (); i++)
+            edge_sets [i].assign (paths [sorted [i]].begin (),
+                    paths [sorted [i]].end ());
+        std::vector <bool> dupl;
+        reduce_paths::superset_paths (edge_sets, dupl, nthreads);
+    });
+
+    time_stage (layout_name, n, "faces", [&] () {
+        FaceData face_data;
+        faces::enumerate (network, face_data);
+    });
+
+    // 100 local edits, each of which deletes one edge and inserts it again,
+    // as for 'face_set_update':
+    FaceGraph face_graph;
+    if (face_update::build (network, face_graph))
+    {
+        time_stage (layout_name, n, "face_update", [&] () {
+            const std::vector <index_t> no_deletions;
+            const std::vector <FaceInsert> no_insertions;
+            FaceDiff diff;
+            for (size_t k = 0; k < 100; k++)
+            {
+                const index_t e = static_cast <index_t> (k * n / 100);
+                if (!face_graph.active [e])
+                    continue;
+                const OneEdge edge = face_graph.edges [e];
+                face_update::update (face_graph,
+                        std::vector <index_t> (1, e), no_insertions, diff);
+                face_update::update (face_graph, no_deletions,
+                        std::vector <FaceInsert> (1, FaceInsert {edge.v0,
+                            edge.v1, edge.x0, edge.y0, edge.x1, edge.y1}),
+                        diff);
+            }
+        });
+    }
+
+    // Each undirected edge is treated as a contracted edge of between one and
+    // four original edges, and all traced paths are expanded:
+    std::vector <index_t> edge_new;
+    for (index_t e = 0; e < network.n_undir; e++)
+        for (index_t k = 0; k <= e % 4; k++)
+            edge_new.push_back (e);
+    time_stage (layout_name, n, "expand_edges", [&] () {
+        EdgeMap emap;
+        edge_map::build (edge_new, network.n_undir, emap);
+        size_t n_expanded = 0;
+        std::vector <index_t> expanded;
+        for (const auto &p: paths)
+        {
+            expanded.clear ();
+            for (auto e: p)
+            {
+                const index_t u = network.edge_undir [e];
+                expanded.insert (expanded.end (),
+                        emap.edges_old.begin () + emap.offsets [u],
+                        emap.edges_old.begin () + emap.offsets [u + 1]);
+            }
+            n_expanded += expanded.size ();
+        }
+        if (n_expanded == 0)
+            std::printf ("No paths were expanded\n");
+    });
+}
+
+int main (int argc, char *argv [])
+{
+    std::vector <size_t> sizes = {1000, 10000, 100000, 1000000};
+    std::vector <std::string> layouts = {"grid", "irregular", "trees"};
+    int nthreads = 1;
+    unsigned seed = 1;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp (argv [i], "-n") == 0)
+        {
+            sizes.clear ();
+            for (char *s = std::strtok (argv [i + 1], ","); s != nullptr;
+                    s = std::strtok (nullptr, ","))
+                sizes.push_back (static_cast <size_t> (std::atof (s)));
+        } else if (std::strcmp (argv [i], "-l") == 0)
+        {
+            layouts.clear ();
+            for (char *s = std::strtok (argv [i + 1], ","); s != nullptr;
+                    s = std::strtok (nullptr, ","))
+                layouts.push_back (s);
+        } else if (std::strcmp (argv [i], "-t") == 0)
+            nthreads = std::atoi (argv [i + 1]);
+        else if (std::strcmp (argv [i], "-s") == 0)
+            seed = static_cast <unsigned> (std::atoi (argv [i + 1]));
+        else
+        {
+            std::fprintf (stderr, "Usage: %s [-n sizes] [-l layouts] "
+                    "[-t threads] [-s seed]\n", argv [0]);
+            return 1;
+        }
+    }
+
+    std::printf ("%-10s %10s  %-14s %10s %10s %10s\n", "layout", "edges",
+            "stage", "seconds", "Medges/s", "peak_MB");
+    for (auto n: sizes)
+        for (const auto &l: layouts)
+        {
+            Layout layout;
+            if (l == "grid")
+                layout = Layout::GRID;
+            else if (l == "irregular")
+                layout = Layout::IRREGULAR;
+            else if (l == "trees")
+                layout = Layout::TREES;
+            else
+            {
+                std::fprintf (stderr, "Unknown layout '%s'\n", l.c_str ());
+                return 1;
+            }
+            run (layout, l.c_str (), n, nthreads, seed);
+        }
+
+    return 0;
+}
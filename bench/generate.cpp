@@ -0,0 +1,159 @@
+#include "generate.h"
+
+#include <cmath>
+#include <random>
+
+// Add an undirected edge between vertices 'a' and 'b', as a pair of directed
+// edges.
+void generate::add_edge (SynthNetwork &net, const index_t a, const index_t b)
+{
+    const std::string id = "e" + std::to_string (net.edge_ids.size () / 2);
+    const index_t va [2] = {a, b}, vb [2] = {b, a};
+    for (size_t i = 0; i < 2; i++)
+    {
+        net.v0.push_back (va [i]);
+        net.v1.push_back (vb [i]);
+        net.edge_ids.push_back (i == 0 ? id : id + "_rev");
+        net.x0.push_back (net.vx [va [i]]);
+        net.y0.push_back (net.vy [va [i]]);
+        net.x1.push_back (net.vx [vb [i]]);
+        net.y1.push_back (net.vy [vb [i]]);
+    }
+}
+
+// Square grid of vertices with random jitter, of around 'n_edges' directed
+// edges, with around one in ten edges removed.
+void generate::grid (SynthNetwork &net, const size_t n_edges, const unsigned seed)
+{
+    std::mt19937 rng (seed);
+    std::uniform_real_distribution <double> jitter (-0.3, 0.3);
+    std::uniform_real_distribution <double> unif (0.0, 1.0);
+
+    const size_t side = std::max (static_cast <size_t> (2),
+            static_cast <size_t> (std::sqrt (static_cast <double> (n_edges) / 3.6)));
+    net.n_verts = static_cast <index_t> (side * side);
+    net.vx.resize (net.n_verts);
+    net.vy.resize (net.n_verts);
+    for (size_t i = 0; i < side; i++)
+        for (size_t j = 0; j < side; j++)
+        {
+            net.vx [i * side + j] = static_cast <double> (i) + jitter (rng);
+            net.vy [i * side + j] = static_cast <double> (j) + jitter (rng);
+        }
+
+    for (size_t i = 0; i < side; i++)
+        for (size_t j = 0; j < side; j++)
+        {
+            const index_t v = static_cast <index_t> (i * side + j);
+            if (i + 1 < side && unif (rng) > 0.1)
+                generate::add_edge (net, v, static_cast <index_t> (v + side));
+            if (j + 1 < side && unif (rng) > 0.1)
+                generate::add_edge (net, v, v + 1);
+        }
+}
+
+// Irregular, Voronoi-like blocks, from a jittered grid with random diagonals
+// across each cell, with around one third of all edges then removed, so that
+// blocks have between three and many sides.
+void generate::irregular (SynthNetwork &net, const size_t n_edges,
+        const unsigned seed)
+{
+    std::mt19937 rng (seed);
+    std::uniform_real_distribution <double> jitter (-0.25, 0.25);
+    std::uniform_real_distribution <double> unif (0.0, 1.0);
+
+    const size_t side = std::max (static_cast <size_t> (2),
+            static_cast <size_t> (std::sqrt (static_cast <double> (n_edges) / 4.0)));
+    net.n_verts = static_cast <index_t> (side * side);
+    net.vx.resize (net.n_verts);
+    net.vy.resize (net.n_verts);
+    for (size_t i = 0; i < side; i++)
+        for (size_t j = 0; j < side; j++)
+        {
+            net.vx [i * side + j] = static_cast <double> (i) + jitter (rng);
+            net.vy [i * side + j] = static_cast <double> (j) + jitter (rng);
+        }
+
+    for (size_t i = 0; i < side; i++)
+        for (size_t j = 0; j < side; j++)
+        {
+            const index_t v = static_cast <index_t> (i * side + j);
+            const index_t s = static_cast <index_t> (side);
+            if (i + 1 < side && unif (rng) > 0.33)
+                generate::add_edge (net, v, v + s);
+            if (j + 1 < side && unif (rng) > 0.33)
+                generate::add_edge (net, v, v + 1);
+            if (i + 1 < side && j + 1 < side && unif (rng) > 0.33)
+            {
+                if (unif (rng) < 0.5)
+                    generate::add_edge (net, v, v + s + 1);
+                else
+                    generate::add_edge (net, v + 1, v + s);
+            }
+        }
+}
+
+// Jittered grid with half of all edges in long dead-end trees, grown from
+// random grid vertices in short random steps, which stress the removal of
+// terminal edges.
+void generate::trees (SynthNetwork &net, const size_t n_edges,
+        const unsigned seed)
+{
+    generate::grid (net, n_edges / 2, seed);
+
+    std::mt19937 rng (seed + 1);
+    std::uniform_real_distribution <double> unif (0.0, 1.0);
+    std::uniform_int_distribution <index_t> grid_vert (0, net.n_verts - 1);
+    const double pi = 3.14159265358979323846;
+
+    while (net.v0.size () < n_edges)
+    {
+        index_t v = grid_vert (rng);
+        const size_t len = 5 + static_cast <size_t> (unif (rng) * 50.0);
+        double angle = unif (rng) * 2.0 * pi;
+        for (size_t k = 0; k < len && net.v0.size () < n_edges; k++)
+        {
+            angle += (unif (rng) - 0.5);
+            net.vx.push_back (net.vx [v] + 0.05 * std::cos (angle));
+            net.vy.push_back (net.vy [v] + 0.05 * std::sin (angle));
+            const index_t w = net.n_verts++;
+            generate::add_edge (net, v, w);
+            // Occasional branches restart from earlier vertices of the tree:
+            if (unif (rng) > 0.8)
+                angle += pi / 2.0;
+            else
+                v = w;
+        }
+    }
+}
+
+void generate::network (SynthNetwork &net,
+        const Layout layout,
+        const size_t n_edges,
+        const unsigned seed)
+{
+    net = SynthNetwork ();
+    if (layout == Layout::GRID)
+        generate::grid (net, n_edges, seed);
+    else if (layout == Layout::IRREGULAR)
+        generate::irregular (net, n_edges, seed);
+    else
+        generate::trees (net, n_edges, seed);
+}
+
+// Network columns as views of the synthetic network, which must outlive them.
+void generate::columns (const SynthNetwork &net, NetworkColumns &cols)
+{
+    cols.n_verts = net.n_verts;
+    cols.v0 = net.v0;
+    cols.v1 = net.v1;
+    cols.vert_named.assign (net.n_verts, true);
+    cols.edge_ids.resize (net.edge_ids.size ());
+    for (size_t i = 0; i < net.edge_ids.size (); i++)
+        cols.edge_ids [i] = CharView {net.edge_ids [i].data (),
+            net.edge_ids [i].size ()};
+    cols.x0 = net.x0.data ();
+    cols.y0 = net.y0.data ();
+    cols.x1 = net.x1.data ();
+    cols.y1 = net.y1.data ();
+}
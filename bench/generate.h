@@ -0,0 +1,40 @@
+#pragma once
+
+#include "typedefs.h"
+#include "cycles.h"
+
+#include <string>
+#include <vector>
+
+// Synthetic network of duplicated edges, each with a reversed equivalent with
+// a "_rev" suffix, holding the data referenced by 'NetworkColumns'.
+struct SynthNetwork
+{
+    index_t n_verts = 0;
+    std::vector <index_t> v0;
+    std::vector <index_t> v1;
+    std::vector <std::string> edge_ids;
+    std::vector <double> x0, y0, x1, y1;
+    std::vector <double> vx, vy; // vertex coordinates
+};
+
+enum class Layout { GRID, IRREGULAR, TREES };
+
+namespace generate {
+
+void add_edge (SynthNetwork &net, const index_t a, const index_t b);
+
+void grid (SynthNetwork &net, const size_t n_edges, const unsigned seed);
+
+void irregular (SynthNetwork &net, const size_t n_edges, const unsigned seed);
+
+void trees (SynthNetwork &net, const size_t n_edges, const unsigned seed);
+
+void network (SynthNetwork &net,
+        const Layout layout,
+        const size_t n_edges,
+        const unsigned seed);
+
+void columns (const SynthNetwork &net, NetworkColumns &cols);
+
+} // end namespace generate
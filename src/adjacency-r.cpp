@@ -0,0 +1,84 @@
+#include "typedefs.h"
+#include "adjacency.h"
+#include "utils.h"
+#include "ingest.h"
+#include "stats.h"
+
+#include "cpp11.hpp"
+
+using namespace cpp11;
+
+// Find all pairs of adjacent cycles from a list of edge IDs of each cycle.
+// Return value is a list of three items: 1-based "from" and "to" cycles, and a
+// list of shared edge IDs for each pair, with "_rev" suffixes removed.
+[[cpp11::register]]
+writable::list cpp_adjacent_cycles(list cycles_in)
+{
+    stats::PhaseTimer timer ("adjacent_cycles");
+
+    const size_t n = static_cast <size_t> (cycles_in.size ());
+
+    // Edge IDs with "_rev" suffixes removed, and the CHARSXP values from which
+    // each was first obtained:
+    std::unordered_map <CharView, index_t, CharViewHash> edge_map;
+    std::vector <CharView> edge_ids;
+    std::vector <SEXP> edge_src;
+    std::vector <std::vector <index_t> > cycles (n);
+
+    std::vector <CharView> views;
+    for (size_t i = 0; i < n; i++)
+    {
+        const SEXP edges = cycles_in [static_cast <R_xlen_t> (i)];
+        ingest::char_views (edges, views);
+        cycles [i].reserve (views.size ());
+        for (size_t j = 0; j < views.size (); j++)
+        {
+            const CharView this_edge = utils::cut_terminal_rev (views [j]);
+            auto it = edge_map.emplace (this_edge,
+                    static_cast <index_t> (edge_ids.size ()));
+            if (it.second)
+            {
+                edge_ids.push_back (this_edge);
+                edge_src.push_back (STRING_ELT (edges, static_cast <R_xlen_t> (j)));
+            }
+            cycles [i].push_back (it.first->second);
+        }
+    }
+
+    // Each unique edge ID is converted back to a CHARSXP only once:
+    std::vector <SEXP> edge_chars (edge_ids.size (), R_NilValue);
+
+    AdjacencyData adj;
+    adjacency::adjacent_cycles (cycles,
+            static_cast <index_t> (edge_ids.size ()), adj);
+
+    const R_xlen_t npairs = static_cast <R_xlen_t> (adj.from.size ());
+    writable::integers from (npairs), to (npairs);
+    writable::list edges (npairs);
+    for (R_xlen_t i = 0; i < npairs; i++)
+    {
+        from [i] = static_cast <int> (adj.from [static_cast <size_t> (i)]) + 1L;
+        to [i] = static_cast <int> (adj.to [static_cast <size_t> (i)]) + 1L;
+
+        const index_t e0 = adj.offsets [static_cast <size_t> (i)],
+              e1 = adj.offsets [static_cast <size_t> (i) + 1];
+        writable::strings edges_i (static_cast <R_xlen_t> (e1 - e0));
+        for (index_t j = e0; j < e1; j++)
+        {
+            const index_t e = adj.edges [j];
+            if (edge_chars [e] == R_NilValue)
+                edge_chars [e] = ingest::view_to_char (edge_ids [e],
+                        edge_src [e]);
+            SET_STRING_ELT (edges_i, static_cast <R_xlen_t> (j - e0),
+                    edge_chars [e]);
+        }
+        edges [i] = edges_i;
+    }
+
+    writable::list res (3);
+    res [0] = from;
+    res [1] = to;
+    res [2] = edges;
+
+    return res;
+}
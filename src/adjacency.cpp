@@ -0,0 +1,104 @@
+#include "adjacency.h"
+
+#include <algorithm>
+
+// Inverted index from each edge to all cycles which contain it, in compressed
+// sparse row form, so that the cycles containing edge 'e' are
+// index_cycles [index_offset [e]:(index_offset [e + 1] - 1)], in increasing
+// order.
+void adjacency::edge_index (const std::vector <std::vector <index_t> > &cycles,
+        const index_t n_edges,
+        std::vector <index_t> &index_offset,
+        std::vector <index_t> &index_cycles)
+{
+    // Stamp edges with (cycle + 1) to count each edge once per cycle:
+    std::vector <index_t> stamp (n_edges, 0L);
+
+    index_offset.assign (n_edges + 1, 0L);
+    for (index_t i = 0; i < cycles.size (); i++)
+    {
+        for (auto e: cycles [i])
+        {
+            if (stamp [e] != i + 1)
+            {
+                stamp [e] = i + 1;
+                index_offset [e + 1]++;
+            }
+        }
+    }
+    for (index_t e = 0; e < n_edges; e++)
+        index_offset [e + 1] += index_offset [e];
+
+    std::fill (stamp.begin (), stamp.end (), 0L);
+    index_cycles.resize (index_offset.back ());
+    std::vector <index_t> pos (index_offset.begin (), index_offset.end () - 1);
+    for (index_t i = 0; i < cycles.size (); i++)
+    {
+        for (auto e: cycles [i])
+        {
+            if (stamp [e] != i + 1)
+            {
+                stamp [e] = i + 1;
+                index_cycles [pos [e]++] = i;
+            }
+        }
+    }
+}
+
+// Find all pairs of cycles which share edges, in order of increasing 'from'
+// and then 'to' cycles. Shared edges are listed in the order of the 'to' cycle,
+// including repeated edges. Each cycle is only compared with cycles which
+// share at least one edge, so total time is linear in the sizes of all cycles
+// and their neighbours.
+void adjacency::adjacent_cycles (
+        const std::vector <std::vector <index_t> > &cycles,
+        const index_t n_edges,
+        AdjacencyData &adj)
+{
+    std::vector <index_t> index_offset, index_cycles;
+    adjacency::edge_index (cycles, n_edges, index_offset, index_cycles);
+
+    adj.from.clear ();
+    adj.to.clear ();
+    adj.edges.clear ();
+    adj.offsets.assign (1, 0L);
+
+    const index_t n = static_cast <index_t> (cycles.size ());
+    std::vector <index_t> edge_stamp (n_edges, 0L);
+    std::vector <index_t> cycle_stamp (n, 0L);
+    std::vector <index_t> nbs;
+
+    for (index_t i = 0; i < n; i++)
+    {
+        nbs.clear ();
+        for (auto e: cycles [i])
+        {
+            if (edge_stamp [e] == i + 1)
+                continue;
+            edge_stamp [e] = i + 1;
+
+            for (index_t k = index_offset [e]; k < index_offset [e + 1]; k++)
+            {
+                const index_t j = index_cycles [k];
+                if (j != i && cycle_stamp [j] != i + 1)
+                {
+                    cycle_stamp [j] = i + 1;
+                    nbs.push_back (j);
+                }
+            }
+        }
+        std::sort (nbs.begin (), nbs.end ());
+
+        for (auto j: nbs)
+        {
+            adj.from.push_back (i);
+            adj.to.push_back (j);
+            for (auto e: cycles [j])
+            {
+                if (edge_stamp [e] == i + 1)
+                    adj.edges.push_back (e);
+            }
+            adj.offsets.push_back (static_cast <index_t> (adj.edges.size ()));
+        }
+    }
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "typedefs.h"
+
+#include <vector>
+
+// Pairs of adjacent cycles, with the shared edges of each pair in
+// edges [offsets [i]:(offsets [i + 1] - 1)].
+struct AdjacencyData
+{
+    std::vector <index_t> from;
+    std::vector <index_t> to;
+    std::vector <index_t> offsets;
+    std::vector <index_t> edges;
+};
+
+namespace adjacency {
+
+void edge_index (const std::vector <std::vector <index_t> > &cycles,
+        const index_t n_edges,
+        std::vector <index_t> &index_offset,
+        std::vector <index_t> &index_cycles);
+
+void adjacent_cycles (const std::vector <std::vector <index_t> > &cycles,
+        const index_t n_edges,
+        AdjacencyData &adj);
+
+} // end namespace adjacency
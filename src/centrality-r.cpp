@@ -0,0 +1,206 @@
+#include "typedefs.h"
+#include "ingest.h"
+#include "centrality.h"
+#include "scoring.h"
+#include "stats.h"
+
+#include "cpp11.hpp"
+
+#include <cmath>
+#include <memory> // unique_ptr
+
+using namespace cpp11;
+
+// Get the engine held by an external pointer returned from
+// 'cpp_centrality_engine'.
+const CentralityEngine &centrality_get_engine (SEXP engine)
+{
+    external_pointer <CentralityEngine> ptr (engine);
+    if (ptr.get () == nullptr)
+        cpp11::stop ("Centrality engine is no longer valid; it must be rebuilt");
+    return *ptr;
+}
+
+// Build a centrality engine from a directed network with columns of ".vx0",
+// ".vx1", and the numeric column 'weight', calculating betweenness of the full
+// network once. Return value is an external pointer which can be passed to
+// all subsequent calls.
+[[cpp11::register]]
+SEXP cpp_centrality_engine(list df, const std::string weight,
+        const int nthreads)
+{
+    stats::PhaseTimer timer ("centrality_engine");
+
+    const SEXP vx0 = ingest::string_column (df, ".vx0");
+    const SEXP vx1 = ingest::string_column (df, ".vx1");
+
+    CharMap vert_map;
+    vert_map.reserve (static_cast <size_t> (Rf_xlength (vx0)));
+    std::vector <SEXP> verts;
+    std::vector <index_t> v0, v1;
+    ingest::intern_chars (vx0, vert_map, verts, v0);
+    ingest::intern_chars (vx1, vert_map, verts, v1);
+
+    std::unique_ptr <CentralityEngine> engine (new CentralityEngine);
+    centrality::build_graph (engine->graph, v0, v1,
+            static_cast <index_t> (verts.size ()),
+            ingest::real_column (df, weight));
+    centrality::build_engine (*engine, nthreads);
+
+    external_pointer <CentralityEngine> ptr (engine.release ());
+
+    return ptr;
+}
+
+// Betweenness of all edges of the full network.
+[[cpp11::register]]
+writable::doubles cpp_centrality_values(SEXP engine)
+{
+    const CentralityEngine &eng = centrality_get_engine (engine);
+
+    const size_t n = eng.betweenness.size ();
+    writable::doubles res (static_cast <R_xlen_t> (n));
+    for (size_t i = 0; i < n; i++)
+        res [static_cast <R_xlen_t> (i)] = eng.betweenness [i];
+
+    return res;
+}
+
+// Change in betweenness of all edges from removing the edges with 1-based
+// indices of 'cut_edges'. Return value is a list of the changes, and the
+// number of sources which were recomputed.
+[[cpp11::register]]
+writable::list cpp_centrality_delta(SEXP engine, integers cut_edges,
+        const int nthreads)
+{
+    stats::PhaseTimer timer ("centrality_delta");
+
+    const CentralityEngine &eng = centrality_get_engine (engine);
+
+    std::vector <index_t> cut (static_cast <size_t> (cut_edges.size ()));
+    for (size_t i = 0; i < cut.size (); i++)
+    {
+        const int e = cut_edges [static_cast <R_xlen_t> (i)];
+        if (e < 1 || static_cast <size_t> (e) > eng.betweenness.size ())
+            cpp11::stop ("Edge indices must be within the network");
+        cut [i] = static_cast <index_t> (e - 1);
+    }
+
+    std::vector <double> delta;
+    size_t n_affected;
+    centrality::delta (eng, cut, nthreads, delta, n_affected);
+
+    writable::doubles delta_out (static_cast <R_xlen_t> (delta.size ()));
+    for (size_t i = 0; i < delta.size (); i++)
+        delta_out [static_cast <R_xlen_t> (i)] = delta [i];
+
+    writable::integers n_affected_out (1);
+    n_affected_out [0] = static_cast <int> (n_affected);
+
+    writable::list res (2);
+    res [0] = delta_out;
+    res [1] = n_affected_out;
+
+    return res;
+}
+
+// Flat vector of 0-based network edge indices from 1-based R indices.
+void centrality_edge_indices (const integers &edges_in,
+        const CentralityEngine &engine,
+        std::vector <index_t> &edges)
+{
+    edges.resize (static_cast <size_t> (edges_in.size ()));
+    for (size_t i = 0; i < edges.size (); i++)
+    {
+        const int e = edges_in [static_cast <R_xlen_t> (i)];
+        if (e < 1 || static_cast <size_t> (e) > engine.betweenness.size ())
+            cpp11::stop ("Edge indices must be within the network");
+        edges [i] = static_cast <index_t> (e - 1);
+    }
+}
+
+// Offsets of candidates into flat vectors of 'n_edges' edges, which must start
+// at 0, be non-decreasing, and end at 'n_edges'.
+void centrality_offsets (const integers &offsets_in,
+        const size_t n_edges,
+        const char *name,
+        std::vector <index_t> &offsets)
+{
+    offsets.resize (static_cast <size_t> (offsets_in.size ()));
+    for (size_t i = 0; i < offsets.size (); i++)
+    {
+        const int o = offsets_in [static_cast <R_xlen_t> (i)];
+        if (o < 0 || (i == 0 && o != 0) ||
+                (i > 0 && static_cast <index_t> (o) < offsets [i - 1]))
+            cpp11::stop ("%s must be non-decreasing offsets starting at 0",
+                    name);
+        offsets [i] = static_cast <index_t> (o);
+    }
+    if (offsets.back () != n_edges)
+        cpp11::stop ("The last value of %s must equal the number of edges",
+                name);
+}
+
+// Score cuts of a batch of candidate pairs, with 1-based edge indices along
+// and off the shared boundary of each pair in flat vectors, with offsets
+// starting at 0. Progress is reported on stderr unless 'quiet'. Return value
+// is a list of relative decreases in centrality along, and increases around,
+// each boundary, and 1-based indices of cut edges.
+[[cpp11::register]]
+writable::list cpp_score_cuts(SEXP engine, doubles d, integers in_edges,
+        integers in_offsets, integers out_edges, integers out_offsets,
+        const int nthreads, const bool quiet)
+{
+    stats::PhaseTimer timer ("score_cuts");
+
+    const CentralityEngine &eng = centrality_get_engine (engine);
+    if (static_cast <size_t> (d.size ()) != eng.betweenness.size ())
+        cpp11::stop ("d must have one value for each edge of the network");
+    if (in_offsets.size () != out_offsets.size () || in_offsets.size () < 1)
+        cpp11::stop ("in_offsets and out_offsets must have equal lengths");
+
+    CutCandidates candidates;
+    centrality_edge_indices (in_edges, eng, candidates.in_edges);
+    centrality_edge_indices (out_edges, eng, candidates.out_edges);
+    centrality_offsets (in_offsets, candidates.in_edges.size (), "in_offsets",
+            candidates.in_offsets);
+    centrality_offsets (out_offsets, candidates.out_edges.size (),
+            "out_offsets", candidates.out_offsets);
+    const size_t n = candidates.in_offsets.size () - 1;
+
+    // Progress is only reported when it changes, from the main thread:
+    size_t n_reported = 0;
+    auto progress = [&] (const size_t n_done) {
+        if (quiet || n_done == n_reported)
+            return;
+        n_reported = n_done;
+        REprintf ("\rScored %zu / %zu candidates", n_done, n);
+        if (n_done == n)
+            REprintf ("\n");
+    };
+
+    CutScores scores;
+    scoring::score_batch (eng, REAL (d), candidates, nthreads, progress,
+            scores);
+
+    writable::doubles decr_in (static_cast <R_xlen_t> (n));
+    writable::doubles incr_out (static_cast <R_xlen_t> (n));
+    writable::integers cut_edge (static_cast <R_xlen_t> (n));
+    for (size_t i = 0; i < n; i++)
+    {
+        const R_xlen_t ir = static_cast <R_xlen_t> (i);
+        decr_in [ir] = std::isnan (scores.decr_in [i]) ?
+            NA_REAL : scores.decr_in [i];
+        incr_out [ir] = std::isnan (scores.incr_out [i]) ?
+            NA_REAL : scores.incr_out [i];
+        cut_edge [ir] = scores.cut_edge [i] == INFINITE_INDEX ?
+            NA_INTEGER : static_cast <int> (scores.cut_edge [i]) + 1;
+    }
+
+    writable::list res (3);
+    res [0] = decr_in;
+    res [1] = incr_out;
+    res [2] = cut_edge;
+
+    return res;
+}
@@ -0,0 +1,292 @@
+#include "centrality.h"
+#include "threads.h"
+
+#include <algorithm>
+#include <cmath>
+#include <queue>
+
+// Relative tolerance in comparing path lengths calculated forwards and
+// backwards, which may differ through rounding only:
+const double CENTRALITY_TOL = 1.0e-10;
+// Number of sources in each block of betweenness sums:
+const size_t CENTRALITY_BLOCK = 16;
+
+// Build a graph of edges from v0 to v1. Junction vertices are all except
+// those with exactly two distinct neighbours, which are the vertices removed
+// from contracted graphs.
+void centrality::build_graph (CentralityGraph &graph,
+        const std::vector <index_t> &v0,
+        const std::vector <index_t> &v1,
+        const index_t n_verts,
+        const double *weight)
+{
+    const size_t n_edges = v0.size ();
+    graph.n_verts = n_verts;
+    graph.from = v0;
+    graph.to = v1;
+    graph.weight.resize (n_edges);
+    for (size_t i = 0; i < n_edges; i++)
+        graph.weight [i] = std::isfinite (weight [i]) && weight [i] >= 0.0 ?
+            weight [i] : INFINITY;
+
+    // Counting sorts of edges by start and end vertices, which retain the
+    // order of edges for each vertex:
+    graph.out_offset.assign (n_verts + 1, 0);
+    graph.in_offset.assign (n_verts + 1, 0);
+    for (size_t i = 0; i < n_edges; i++)
+    {
+        graph.out_offset [v0 [i] + 1]++;
+        graph.in_offset [v1 [i] + 1]++;
+    }
+    for (index_t v = 0; v < n_verts; v++)
+    {
+        graph.out_offset [v + 1] += graph.out_offset [v];
+        graph.in_offset [v + 1] += graph.in_offset [v];
+    }
+    graph.out_edges.resize (n_edges);
+    graph.in_edges.resize (n_edges);
+    std::vector <index_t> out_pos (graph.out_offset.begin (),
+            graph.out_offset.end () - 1);
+    std::vector <index_t> in_pos (graph.in_offset.begin (),
+            graph.in_offset.end () - 1);
+    for (size_t i = 0; i < n_edges; i++)
+    {
+        graph.out_edges [out_pos [v0 [i]]++] = static_cast <index_t> (i);
+        graph.in_edges [in_pos [v1 [i]]++] = static_cast <index_t> (i);
+    }
+
+    // Distinct neighbours in either direction, ignoring self-loops:
+    graph.junction.assign (n_verts, true);
+    std::vector <index_t> nbs;
+    for (index_t v = 0; v < n_verts; v++)
+    {
+        nbs.clear ();
+        for (index_t j = graph.out_offset [v]; j < graph.out_offset [v + 1]; j++)
+            nbs.push_back (v1 [graph.out_edges [j]]);
+        for (index_t j = graph.in_offset [v]; j < graph.in_offset [v + 1]; j++)
+            nbs.push_back (v0 [graph.in_edges [j]]);
+        std::sort (nbs.begin (), nbs.end ());
+        nbs.erase (std::unique (nbs.begin (), nbs.end ()), nbs.end ());
+        nbs.erase (std::remove (nbs.begin (), nbs.end (), v), nbs.end ());
+        graph.junction [v] = nbs.size () != 2;
+    }
+}
+
+// Shortest paths from 'source', or to 'source' where 'reverse' is true,
+// without any edges marked in 'removed', which may be empty. Fills distances,
+// and, for forward paths only, numbers of shortest paths in 'sigma', and
+// vertices in the order in which they are settled.
+void centrality::dijkstra (const CentralityGraph &graph,
+        const index_t source,
+        const std::vector <bool> &removed,
+        const bool reverse,
+        BrandesWork &work)
+{
+    work.dist.assign (graph.n_verts, INFINITY);
+    work.sigma.assign (graph.n_verts, 0.0);
+    work.order.clear ();
+
+    typedef std::pair <double, index_t> QueueItem;
+    std::priority_queue <QueueItem, std::vector <QueueItem>,
+        std::greater <QueueItem> > queue;
+
+    const std::vector <index_t> &offset = reverse ?
+        graph.in_offset : graph.out_offset;
+    const std::vector <index_t> &edges = reverse ?
+        graph.in_edges : graph.out_edges;
+    const std::vector <index_t> &next_vert = reverse ? graph.from : graph.to;
+
+    work.dist [source] = 0.0;
+    work.sigma [source] = 1.0;
+    queue.push (QueueItem (0.0, source));
+    while (!queue.empty ())
+    {
+        const QueueItem item = queue.top ();
+        queue.pop ();
+        const index_t v = item.second;
+        if (item.first > work.dist [v])
+            continue;
+        work.order.push_back (v);
+
+        for (index_t j = offset [v]; j < offset [v + 1]; j++)
+        {
+            const index_t e = edges [j];
+            if (!removed.empty () && removed [e])
+                continue;
+            const double d = work.dist [v] + graph.weight [e];
+            const index_t w = next_vert [e];
+            if (d < work.dist [w])
+            {
+                work.dist [w] = d;
+                work.sigma [w] = work.sigma [v];
+                queue.push (QueueItem (d, w));
+            } else if (d == work.dist [w] && !reverse)
+                work.sigma [w] += work.sigma [v];
+        }
+    }
+}
+
+// Add 'sign' times the betweenness contributions of all shortest paths from
+// 'source' to all junction vertices to 'betweenness', following Brandes
+// (2008). Shortest-path DAG edges into each vertex are those in-edges which
+// exactly extend the distance of their start vertex, so no predecessor lists
+// need be stored.
+void centrality::brandes_source (const CentralityGraph &graph,
+        const index_t source,
+        const std::vector <bool> &removed,
+        const double sign,
+        BrandesWork &work,
+        std::vector <double> &betweenness)
+{
+    centrality::dijkstra (graph, source, removed, false, work);
+
+    work.dep.assign (graph.n_verts, 0.0);
+    for (size_t i = work.order.size (); i-- > 1; )
+    {
+        const index_t w = work.order [i];
+        const double dep_w = (graph.junction [w] ? 1.0 : 0.0) + work.dep [w];
+        for (index_t j = graph.in_offset [w]; j < graph.in_offset [w + 1]; j++)
+        {
+            const index_t e = graph.in_edges [j];
+            if (!removed.empty () && removed [e])
+                continue;
+            const index_t v = graph.from [e];
+            if (work.dist [v] + graph.weight [e] != work.dist [w])
+                continue;
+            const double c = work.sigma [v] / work.sigma [w] * dep_w;
+            betweenness [e] += sign * c;
+            work.dep [v] += c;
+        }
+    }
+}
+
+// Sum betweenness from all 'sources' or, where 'removed' is not empty, changes
+// in betweenness from removing those edges. Sources are summed in fixed blocks
+// which are added in block order, so results are identical for any number of
+// threads. Blocks are calculated in rounds of a few per thread, to limit the
+// memory of all block sums.
+void centrality::sum_sources (const CentralityGraph &graph,
+        const std::vector <index_t> &sources,
+        const std::vector <bool> &removed,
+        const int nthreads,
+        std::vector <double> &sums)
+{
+    const size_t n_edges = graph.from.size ();
+    const size_t n_blocks = (sources.size () + CENTRALITY_BLOCK - 1) /
+        CENTRALITY_BLOCK;
+    const size_t n_round = 2 * threads::n_threads (nthreads, n_blocks);
+    const std::vector <bool> none;
+
+    sums.assign (n_edges, 0.0);
+    std::vector <std::vector <double> > block_sums;
+
+    for (size_t b0 = 0; b0 < n_blocks; b0 += n_round)
+    {
+        const size_t nb = std::min (n_round, n_blocks - b0);
+        block_sums.resize (nb);
+
+        threads::parallel_for (nb, nthreads,
+                [&] (size_t from, size_t to, size_t) {
+                    BrandesWork work;
+                    for (size_t b = from; b < to; b++)
+                    {
+                        std::vector <double> &bs = block_sums [b];
+                        bs.assign (n_edges, 0.0);
+                        const size_t i0 = (b0 + b) * CENTRALITY_BLOCK;
+                        const size_t i1 = std::min (i0 + CENTRALITY_BLOCK,
+                                sources.size ());
+                        for (size_t i = i0; i < i1; i++)
+                        {
+                            if (removed.empty ())
+                            {
+                                centrality::brandes_source (graph,
+                                        sources [i], none, 1.0, work, bs);
+                                continue;
+                            }
+                            centrality::brandes_source (graph, sources [i],
+                                    none, -1.0, work, bs);
+                            centrality::brandes_source (graph, sources [i],
+                                    removed, 1.0, work, bs);
+                        }
+                    }
+                });
+
+        for (const auto &bs: block_sums)
+            for (size_t e = 0; e < n_edges; e++)
+                sums [e] += bs [e];
+    }
+}
+
+// Calculate betweenness of the full graph from all junction vertices.
+void centrality::build_engine (CentralityEngine &engine, const int nthreads)
+{
+    const CentralityGraph &graph = engine.graph;
+    engine.sources.clear ();
+    for (index_t v = 0; v < graph.n_verts; v++)
+        if (graph.junction [v])
+            engine.sources.push_back (v);
+
+    const std::vector <bool> removed;
+    centrality::sum_sources (graph, engine.sources, removed, nthreads,
+            engine.betweenness);
+}
+
+// Sources whose shortest-path DAGs include any of 'cut_edges'. An edge from u
+// to v is in the DAG of source s if d (s, u) + w = d (s, v), where distances
+// to u and v from all sources come from single backward searches from each.
+void centrality::affected_sources (const CentralityEngine &engine,
+        const std::vector <index_t> &cut_edges,
+        std::vector <index_t> &affected)
+{
+    const CentralityGraph &graph = engine.graph;
+    const std::vector <bool> removed;
+    BrandesWork work_u, work_v;
+
+    std::vector <bool> is_affected (engine.sources.size (), false);
+    for (auto e: cut_edges)
+    {
+        if (!std::isfinite (graph.weight [e]))
+            continue;
+        centrality::dijkstra (graph, graph.from [e], removed, true, work_u);
+        centrality::dijkstra (graph, graph.to [e], removed, true, work_v);
+        for (size_t i = 0; i < engine.sources.size (); i++)
+        {
+            const index_t s = engine.sources [i];
+            const double du = work_u.dist [s] + graph.weight [e];
+            const double dv = work_v.dist [s];
+            if (std::isfinite (du) && du - dv <= CENTRALITY_TOL * dv)
+                is_affected [i] = true;
+        }
+    }
+
+    affected.clear ();
+    for (size_t i = 0; i < engine.sources.size (); i++)
+        if (is_affected [i])
+            affected.push_back (engine.sources [i]);
+}
+
+// Change in betweenness of all edges from removing 'cut_edges', from
+// recomputing only affected sources both with and without the cut edges. Cut
+// edges have changes equal to their negative betweenness.
+void centrality::delta (const CentralityEngine &engine,
+        const std::vector <index_t> &cut_edges,
+        const int nthreads,
+        std::vector <double> &delta,
+        size_t &n_affected)
+{
+    const CentralityGraph &graph = engine.graph;
+
+    std::vector <index_t> affected;
+    centrality::affected_sources (engine, cut_edges, affected);
+    n_affected = affected.size ();
+
+    std::vector <bool> removed (graph.from.size (), false);
+    for (auto e: cut_edges)
+        removed [e] = true;
+
+    centrality::sum_sources (graph, affected, removed, nthreads, delta);
+    // Cut edges are only in DAGs of affected sources, so changes are exactly
+    // their negative betweenness, without rounding errors:
+    for (auto e: cut_edges)
+        delta [e] = -engine.betweenness [e];
+}
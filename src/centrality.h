@@ -0,0 +1,83 @@
+#pragma once
+
+#include "typedefs.h"
+
+#include <vector>
+
+// Directed, weighted graph for betweenness centrality, with edges in
+// compressed sparse row form both forwards (edges out of each vertex) and
+// backwards (edges into each vertex). Edges with non-finite or negative
+// weights are never traversed.
+struct CentralityGraph
+{
+    index_t n_verts;
+    std::vector <index_t> from;
+    std::vector <index_t> to;
+    std::vector <double> weight;
+    std::vector <index_t> out_offset;
+    std::vector <index_t> out_edges;
+    std::vector <index_t> in_offset;
+    std::vector <index_t> in_edges;
+    // Junction vertices, which are both sources and targets of all paths:
+    std::vector <bool> junction;
+};
+
+// Edge betweenness of a full graph, calculated once, from which changes in
+// betweenness from removing edges can be calculated by recomputing only those
+// sources whose shortest-path DAGs include the removed edges.
+struct CentralityEngine
+{
+    CentralityGraph graph;
+    std::vector <index_t> sources;
+    std::vector <double> betweenness;
+};
+
+// Working vectors for single-source shortest paths, reused between sources.
+struct BrandesWork
+{
+    std::vector <double> dist;
+    std::vector <double> sigma;
+    std::vector <double> dep;
+    std::vector <index_t> order;
+};
+
+namespace centrality {
+
+void build_graph (CentralityGraph &graph,
+        const std::vector <index_t> &v0,
+        const std::vector <index_t> &v1,
+        const index_t n_verts,
+        const double *weight);
+
+void dijkstra (const CentralityGraph &graph,
+        const index_t source,
+        const std::vector <bool> &removed,
+        const bool reverse,
+        BrandesWork &work);
+
+void brandes_source (const CentralityGraph &graph,
+        const index_t source,
+        const std::vector <bool> &removed,
+        const double sign,
+        BrandesWork &work,
+        std::vector <double> &betweenness);
+
+void sum_sources (const CentralityGraph &graph,
+        const std::vector <index_t> &sources,
+        const std::vector <bool> &removed,
+        const int nthreads,
+        std::vector <double> &sums);
+
+void build_engine (CentralityEngine &engine, const int nthreads);
+
+void affected_sources (const CentralityEngine &engine,
+        const std::vector <index_t> &cut_edges,
+        std::vector <index_t> &affected);
+
+void delta (const CentralityEngine &engine,
+        const std::vector <index_t> &cut_edges,
+        const int nthreads,
+        std::vector <double> &delta,
+        size_t &n_affected);
+
+} // end namespace centrality
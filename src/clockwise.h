@@ -4,21 +4,11 @@
 
 namespace clockwise {
 
-std::size_t to_left (const double from_x,
-        const double from_y,
-        const double centre_x,
-        const double centre_y,
-        const std::vector <double> nbs_x,
-        const std::vector <double> nbs_y,
-        const bool left);
+bool is_zero (const double x, const double y);
 
-std::size_t to_left_binary (const double from_x,
-        const double from_y,
-        const double centre_x,
-        const double centre_y,
-        const std::vector <double> nbs_x,
-        const std::vector <double> nbs_y,
-        const std::vector <std::size_t> nbs_idx,
-        const bool left = true);
+bool less_angle (const double ax,
+        const double ay,
+        const double bx,
+        const double by);
 
 } // end namespace clockwise
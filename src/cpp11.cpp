@@ -5,41 +5,226 @@
 #include "cpp11/declarations.hpp"
 #include <R_ext/Visibility.h>
 
+// adjacency-r.cpp
+writable::list cpp_adjacent_cycles(list cycles_in);
+extern "C" SEXP _neighbourhoods_cpp_adjacent_cycles(SEXP cycles_in) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(cpp_adjacent_cycles(cpp11::as_cpp<cpp11::decay_t<list>>(cycles_in)));
+  END_CPP11
+}
+// centrality-r.cpp
+SEXP cpp_centrality_engine(list df, const std::string weight, const int nthreads);
+extern "C" SEXP _neighbourhoods_cpp_centrality_engine(SEXP df, SEXP weight, SEXP nthreads) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(cpp_centrality_engine(cpp11::as_cpp<cpp11::decay_t<list>>(df), cpp11::as_cpp<cpp11::decay_t<const std::string>>(weight), cpp11::as_cpp<cpp11::decay_t<const int>>(nthreads)));
+  END_CPP11
+}
+// centrality-r.cpp
+writable::doubles cpp_centrality_values(SEXP engine);
+extern "C" SEXP _neighbourhoods_cpp_centrality_values(SEXP engine) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(cpp_centrality_values(cpp11::as_cpp<cpp11::decay_t<SEXP>>(engine)));
+  END_CPP11
+}
+// centrality-r.cpp
+writable::list cpp_centrality_delta(SEXP engine, integers cut_edges, const int nthreads);
+extern "C" SEXP _neighbourhoods_cpp_centrality_delta(SEXP engine, SEXP cut_edges, SEXP nthreads) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(cpp_centrality_delta(cpp11::as_cpp<cpp11::decay_t<SEXP>>(engine), cpp11::as_cpp<cpp11::decay_t<integers>>(cut_edges), cpp11::as_cpp<cpp11::decay_t<const int>>(nthreads)));
+  END_CPP11
+}
+// centrality-r.cpp
+writable::list cpp_score_cuts(SEXP engine, doubles d, integers in_edges, integers in_offsets, integers out_edges, integers out_offsets, const int nthreads, const bool quiet);
+extern "C" SEXP _neighbourhoods_cpp_score_cuts(SEXP engine, SEXP d, SEXP in_edges, SEXP in_offsets, SEXP out_edges, SEXP out_offsets, SEXP nthreads, SEXP quiet) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(cpp_score_cuts(cpp11::as_cpp<cpp11::decay_t<SEXP>>(engine), cpp11::as_cpp<cpp11::decay_t<doubles>>(d), cpp11::as_cpp<cpp11::decay_t<integers>>(in_edges), cpp11::as_cpp<cpp11::decay_t<integers>>(in_offsets), cpp11::as_cpp<cpp11::decay_t<integers>>(out_edges), cpp11::as_cpp<cpp11::decay_t<integers>>(out_offsets), cpp11::as_cpp<cpp11::decay_t<const int>>(nthreads), cpp11::as_cpp<cpp11::decay_t<const bool>>(quiet)));
+  END_CPP11
+}
+// cycles-r.cpp
+SEXP cpp_network(list df);
+extern "C" SEXP _neighbourhoods_cpp_network(SEXP df) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(cpp_network(cpp11::as_cpp<cpp11::decay_t<list>>(df)));
+  END_CPP11
+}
 // cycles-r.cpp
-writable::list cycles_cpp(list df, strings edge_list, const int start_edge_index, const bool left);
-extern "C" SEXP _neighbourhoods_cycles_cpp(SEXP df, SEXP edge_list, SEXP start_edge_index, SEXP left) {
+writable::list cycles_cpp(SEXP network, logicals active, integers start, const bool left, const int nthreads);
+extern "C" SEXP _neighbourhoods_cycles_cpp(SEXP network, SEXP active, SEXP start, SEXP left, SEXP nthreads) {
   BEGIN_CPP11
-    return cpp11::as_sexp(cycles_cpp(cpp11::as_cpp<cpp11::decay_t<list>>(df), cpp11::as_cpp<cpp11::decay_t<strings>>(edge_list), cpp11::as_cpp<cpp11::decay_t<const int>>(start_edge_index), cpp11::as_cpp<cpp11::decay_t<const bool>>(left)));
+    return cpp11::as_sexp(cycles_cpp(cpp11::as_cpp<cpp11::decay_t<SEXP>>(network), cpp11::as_cpp<cpp11::decay_t<logicals>>(active), cpp11::as_cpp<cpp11::decay_t<integers>>(start), cpp11::as_cpp<cpp11::decay_t<const bool>>(left), cpp11::as_cpp<cpp11::decay_t<const int>>(nthreads)));
   END_CPP11
 }
 // cycles-r.cpp
-writable::logicals cpp_reduce_paths(list edge_list);
-extern "C" SEXP _neighbourhoods_cpp_reduce_paths(SEXP edge_list) {
+writable::list cycles_lr_cpp(SEXP network, const int nthreads);
+extern "C" SEXP _neighbourhoods_cycles_lr_cpp(SEXP network, SEXP nthreads) {
   BEGIN_CPP11
-    return cpp11::as_sexp(cpp_reduce_paths(cpp11::as_cpp<cpp11::decay_t<list>>(edge_list)));
+    return cpp11::as_sexp(cycles_lr_cpp(cpp11::as_cpp<cpp11::decay_t<SEXP>>(network), cpp11::as_cpp<cpp11::decay_t<const int>>(nthreads)));
+  END_CPP11
+}
+// cycles-r.cpp
+writable::list cycles_merge_cpp(SEXP network, list edge_lists);
+extern "C" SEXP _neighbourhoods_cycles_merge_cpp(SEXP network, SEXP edge_lists) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(cycles_merge_cpp(cpp11::as_cpp<cpp11::decay_t<SEXP>>(network), cpp11::as_cpp<cpp11::decay_t<list>>(edge_lists)));
+  END_CPP11
+}
+// cycles-r.cpp
+writable::list cpp_isolated_polygons(SEXP network, list paths_in);
+extern "C" SEXP _neighbourhoods_cpp_isolated_polygons(SEXP network, SEXP paths_in) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(cpp_isolated_polygons(cpp11::as_cpp<cpp11::decay_t<SEXP>>(network), cpp11::as_cpp<cpp11::decay_t<list>>(paths_in)));
+  END_CPP11
+}
+// cycles-r.cpp
+writable::list cpp_faces(SEXP network, const int tiles, const int nthreads);
+extern "C" SEXP _neighbourhoods_cpp_faces(SEXP network, SEXP tiles, SEXP nthreads) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(cpp_faces(cpp11::as_cpp<cpp11::decay_t<SEXP>>(network), cpp11::as_cpp<cpp11::decay_t<const int>>(tiles), cpp11::as_cpp<cpp11::decay_t<const int>>(nthreads)));
+  END_CPP11
+}
+// cycles-r.cpp
+writable::logicals cpp_reduce_paths(list edge_list, const int nthreads);
+extern "C" SEXP _neighbourhoods_cpp_reduce_paths(SEXP edge_list, SEXP nthreads) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(cpp_reduce_paths(cpp11::as_cpp<cpp11::decay_t<list>>(edge_list), cpp11::as_cpp<cpp11::decay_t<const int>>(nthreads)));
   END_CPP11
 }
 // expand_edges.cpp
-writable::list cpp_expand_edges(const list paths, const list edge_map_in, const bool paths_are_list);
-extern "C" SEXP _neighbourhoods_cpp_expand_edges(SEXP paths, SEXP edge_map_in, SEXP paths_are_list) {
+SEXP cpp_edge_map(const list edge_map_in);
+extern "C" SEXP _neighbourhoods_cpp_edge_map(SEXP edge_map_in) {
   BEGIN_CPP11
-    return cpp11::as_sexp(cpp_expand_edges(cpp11::as_cpp<cpp11::decay_t<const list>>(paths), cpp11::as_cpp<cpp11::decay_t<const list>>(edge_map_in), cpp11::as_cpp<cpp11::decay_t<const bool>>(paths_are_list)));
+    return cpp11::as_sexp(cpp_edge_map(cpp11::as_cpp<cpp11::decay_t<const list>>(edge_map_in)));
   END_CPP11
 }
-// preprocess.cpp
+// expand_edges.cpp
+writable::list cpp_expand_edges(SEXP edge_map, const list paths, const bool paths_are_list);
+extern "C" SEXP _neighbourhoods_cpp_expand_edges(SEXP edge_map, SEXP paths, SEXP paths_are_list) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(cpp_expand_edges(cpp11::as_cpp<cpp11::decay_t<SEXP>>(edge_map), cpp11::as_cpp<cpp11::decay_t<const list>>(paths), cpp11::as_cpp<cpp11::decay_t<const bool>>(paths_are_list)));
+  END_CPP11
+}
+// face_update-r.cpp
+writable::list cpp_face_graph(list df);
+extern "C" SEXP _neighbourhoods_cpp_face_graph(SEXP df) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(cpp_face_graph(cpp11::as_cpp<cpp11::decay_t<list>>(df)));
+  END_CPP11
+}
+// face_update-r.cpp
+writable::list cpp_face_update(SEXP graph, const int version, integers deletions, integers v0, integers v1, doubles x0, doubles y0, doubles x1, doubles y1);
+extern "C" SEXP _neighbourhoods_cpp_face_update(SEXP graph, SEXP version, SEXP deletions, SEXP v0, SEXP v1, SEXP x0, SEXP y0, SEXP x1, SEXP y1) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(cpp_face_update(cpp11::as_cpp<cpp11::decay_t<SEXP>>(graph), cpp11::as_cpp<cpp11::decay_t<const int>>(version), cpp11::as_cpp<cpp11::decay_t<integers>>(deletions), cpp11::as_cpp<cpp11::decay_t<integers>>(v0), cpp11::as_cpp<cpp11::decay_t<integers>>(v1), cpp11::as_cpp<cpp11::decay_t<doubles>>(x0), cpp11::as_cpp<cpp11::decay_t<doubles>>(y0), cpp11::as_cpp<cpp11::decay_t<doubles>>(x1), cpp11::as_cpp<cpp11::decay_t<doubles>>(y1)));
+  END_CPP11
+}
+// grid_index-r.cpp
+SEXP cpp_edge_grid(list df);
+extern "C" SEXP _neighbourhoods_cpp_edge_grid(SEXP df) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(cpp_edge_grid(cpp11::as_cpp<cpp11::decay_t<list>>(df)));
+  END_CPP11
+}
+// grid_index-r.cpp
+writable::list cpp_grid_radius(SEXP grid, doubles x, doubles y, const double dmax, const int nthreads);
+extern "C" SEXP _neighbourhoods_cpp_grid_radius(SEXP grid, SEXP x, SEXP y, SEXP dmax, SEXP nthreads) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(cpp_grid_radius(cpp11::as_cpp<cpp11::decay_t<SEXP>>(grid), cpp11::as_cpp<cpp11::decay_t<doubles>>(x), cpp11::as_cpp<cpp11::decay_t<doubles>>(y), cpp11::as_cpp<cpp11::decay_t<const double>>(dmax), cpp11::as_cpp<cpp11::decay_t<const int>>(nthreads)));
+  END_CPP11
+}
+// kdtree-r.cpp
+writable::list cpp_knn(doubles x, doubles y, doubles qx, doubles qy, const int k, const int nthreads);
+extern "C" SEXP _neighbourhoods_cpp_knn(SEXP x, SEXP y, SEXP qx, SEXP qy, SEXP k, SEXP nthreads) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(cpp_knn(cpp11::as_cpp<cpp11::decay_t<doubles>>(x), cpp11::as_cpp<cpp11::decay_t<doubles>>(y), cpp11::as_cpp<cpp11::decay_t<doubles>>(qx), cpp11::as_cpp<cpp11::decay_t<doubles>>(qy), cpp11::as_cpp<cpp11::decay_t<const int>>(k), cpp11::as_cpp<cpp11::decay_t<const int>>(nthreads)));
+  END_CPP11
+}
+// netfile-r.cpp
+void cpp_write_network(list df, SEXP edge_map_in, const std::string hash, const std::string path);
+extern "C" SEXP _neighbourhoods_cpp_write_network(SEXP df, SEXP edge_map_in, SEXP hash, SEXP path) {
+  BEGIN_CPP11
+    cpp_write_network(cpp11::as_cpp<cpp11::decay_t<list>>(df), cpp11::as_cpp<cpp11::decay_t<SEXP>>(edge_map_in), cpp11::as_cpp<cpp11::decay_t<const std::string>>(hash), cpp11::as_cpp<cpp11::decay_t<const std::string>>(path));
+    return R_NilValue;
+  END_CPP11
+}
+// netfile-r.cpp
+writable::list cpp_read_network(const std::string path);
+extern "C" SEXP _neighbourhoods_cpp_read_network(SEXP path) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(cpp_read_network(cpp11::as_cpp<cpp11::decay_t<const std::string>>(path)));
+  END_CPP11
+}
+// pair_stats-r.cpp
+writable::list cpp_pair_stats(integers path_edges, integers path_offsets, integers from, integers to, integers shared_edges, integers shared_offsets, doubles d, doubles centrality, integers highway, const int n_highway, const int nthreads);
+extern "C" SEXP _neighbourhoods_cpp_pair_stats(SEXP path_edges, SEXP path_offsets, SEXP from, SEXP to, SEXP shared_edges, SEXP shared_offsets, SEXP d, SEXP centrality, SEXP highway, SEXP n_highway, SEXP nthreads) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(cpp_pair_stats(cpp11::as_cpp<cpp11::decay_t<integers>>(path_edges), cpp11::as_cpp<cpp11::decay_t<integers>>(path_offsets), cpp11::as_cpp<cpp11::decay_t<integers>>(from), cpp11::as_cpp<cpp11::decay_t<integers>>(to), cpp11::as_cpp<cpp11::decay_t<integers>>(shared_edges), cpp11::as_cpp<cpp11::decay_t<integers>>(shared_offsets), cpp11::as_cpp<cpp11::decay_t<doubles>>(d), cpp11::as_cpp<cpp11::decay_t<doubles>>(centrality), cpp11::as_cpp<cpp11::decay_t<integers>>(highway), cpp11::as_cpp<cpp11::decay_t<const int>>(n_highway), cpp11::as_cpp<cpp11::decay_t<const int>>(nthreads)));
+  END_CPP11
+}
+// polygons-r.cpp
+writable::list cpp_poly_areas(list paths, const std::string method);
+extern "C" SEXP _neighbourhoods_cpp_poly_areas(SEXP paths, SEXP method) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(cpp_poly_areas(cpp11::as_cpp<cpp11::decay_t<list>>(paths), cpp11::as_cpp<cpp11::decay_t<const std::string>>(method)));
+  END_CPP11
+}
+// polygons-r.cpp
+writable::list cpp_poly_centroids(list paths);
+extern "C" SEXP _neighbourhoods_cpp_poly_centroids(SEXP paths) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(cpp_poly_centroids(cpp11::as_cpp<cpp11::decay_t<list>>(paths)));
+  END_CPP11
+}
+// preprocess-r.cpp
 writable::integers cpp_preprocess(list df);
 extern "C" SEXP _neighbourhoods_cpp_preprocess(SEXP df) {
   BEGIN_CPP11
     return cpp11::as_sexp(cpp_preprocess(cpp11::as_cpp<cpp11::decay_t<list>>(df)));
   END_CPP11
 }
+// stats-r.cpp
+writable::list cpp_stats(const bool reset);
+extern "C" SEXP _neighbourhoods_cpp_stats(SEXP reset) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(cpp_stats(cpp11::as_cpp<cpp11::decay_t<const bool>>(reset)));
+  END_CPP11
+}
+// zonal-r.cpp
+writable::list cpp_zonal_stats(list paths, doubles values, const int nrow, doubles grid, const int nthreads);
+extern "C" SEXP _neighbourhoods_cpp_zonal_stats(SEXP paths, SEXP values, SEXP nrow, SEXP grid, SEXP nthreads) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(cpp_zonal_stats(cpp11::as_cpp<cpp11::decay_t<list>>(paths), cpp11::as_cpp<cpp11::decay_t<doubles>>(values), cpp11::as_cpp<cpp11::decay_t<const int>>(nrow), cpp11::as_cpp<cpp11::decay_t<doubles>>(grid), cpp11::as_cpp<cpp11::decay_t<const int>>(nthreads)));
+  END_CPP11
+}
 
 extern "C" {
 static const R_CallMethodDef CallEntries[] = {
-    {"_neighbourhoods_cpp_expand_edges", (DL_FUNC) &_neighbourhoods_cpp_expand_edges, 3},
-    {"_neighbourhoods_cpp_preprocess",   (DL_FUNC) &_neighbourhoods_cpp_preprocess,   1},
-    {"_neighbourhoods_cpp_reduce_paths", (DL_FUNC) &_neighbourhoods_cpp_reduce_paths, 1},
-    {"_neighbourhoods_cycles_cpp",       (DL_FUNC) &_neighbourhoods_cycles_cpp,       4},
+    {"_neighbourhoods_cpp_adjacent_cycles",   (DL_FUNC) &_neighbourhoods_cpp_adjacent_cycles,   1},
+    {"_neighbourhoods_cpp_centrality_delta",  (DL_FUNC) &_neighbourhoods_cpp_centrality_delta,  3},
+    {"_neighbourhoods_cpp_centrality_engine", (DL_FUNC) &_neighbourhoods_cpp_centrality_engine, 3},
+    {"_neighbourhoods_cpp_centrality_values", (DL_FUNC) &_neighbourhoods_cpp_centrality_values, 1},
+    {"_neighbourhoods_cpp_edge_grid",         (DL_FUNC) &_neighbourhoods_cpp_edge_grid,         1},
+    {"_neighbourhoods_cpp_edge_map",          (DL_FUNC) &_neighbourhoods_cpp_edge_map,          1},
+    {"_neighbourhoods_cpp_expand_edges",      (DL_FUNC) &_neighbourhoods_cpp_expand_edges,      3},
+    {"_neighbourhoods_cpp_face_graph",        (DL_FUNC) &_neighbourhoods_cpp_face_graph,        1},
+    {"_neighbourhoods_cpp_face_update",       (DL_FUNC) &_neighbourhoods_cpp_face_update,       9},
+    {"_neighbourhoods_cpp_faces",             (DL_FUNC) &_neighbourhoods_cpp_faces,             3},
+    {"_neighbourhoods_cpp_grid_radius",       (DL_FUNC) &_neighbourhoods_cpp_grid_radius,       5},
+    {"_neighbourhoods_cpp_isolated_polygons", (DL_FUNC) &_neighbourhoods_cpp_isolated_polygons, 2},
+    {"_neighbourhoods_cpp_knn",               (DL_FUNC) &_neighbourhoods_cpp_knn,               6},
+    {"_neighbourhoods_cpp_network",           (DL_FUNC) &_neighbourhoods_cpp_network,           1},
+    {"_neighbourhoods_cpp_pair_stats",        (DL_FUNC) &_neighbourhoods_cpp_pair_stats,        11},
+    {"_neighbourhoods_cpp_poly_areas",        (DL_FUNC) &_neighbourhoods_cpp_poly_areas,        2},
+    {"_neighbourhoods_cpp_poly_centroids",    (DL_FUNC) &_neighbourhoods_cpp_poly_centroids,    1},
+    {"_neighbourhoods_cpp_preprocess",        (DL_FUNC) &_neighbourhoods_cpp_preprocess,        1},
+    {"_neighbourhoods_cpp_read_network",      (DL_FUNC) &_neighbourhoods_cpp_read_network,      1},
+    {"_neighbourhoods_cpp_reduce_paths",      (DL_FUNC) &_neighbourhoods_cpp_reduce_paths,      2},
+    {"_neighbourhoods_cpp_score_cuts",        (DL_FUNC) &_neighbourhoods_cpp_score_cuts,        8},
+    {"_neighbourhoods_cpp_stats",             (DL_FUNC) &_neighbourhoods_cpp_stats,             1},
+    {"_neighbourhoods_cpp_write_network",     (DL_FUNC) &_neighbourhoods_cpp_write_network,     4},
+    {"_neighbourhoods_cpp_zonal_stats",       (DL_FUNC) &_neighbourhoods_cpp_zonal_stats,       5},
+    {"_neighbourhoods_cycles_cpp",            (DL_FUNC) &_neighbourhoods_cycles_cpp,            5},
+    {"_neighbourhoods_cycles_lr_cpp",         (DL_FUNC) &_neighbourhoods_cycles_lr_cpp,         2},
+    {"_neighbourhoods_cycles_merge_cpp",      (DL_FUNC) &_neighbourhoods_cycles_merge_cpp,      2},
     {NULL, NULL, 0}
 };
 }
@@ -1,80 +1,253 @@
 #include "typedefs.h"
-#include "preprocess.h"
+#include "ingest.h"
 #include "cycles.h"
+#include "faces.h"
+#include "isolated.h"
+#include "reduce_paths.h"
 #include "utils.h"
+#include "stats.h"
 
 #include "cpp11.hpp"
-#include "utils.h"
-#include <unordered_set>
+
+#include <memory> // unique_ptr
 
 using namespace cpp11;
 
-template <typename T1, typename T2>
-void cycles_copy_column (
-        const list &df,
-        const std::string &col,
-        std::vector <T2> &result)
+// Get the network held by an external pointer returned from 'cpp_network'.
+const Network &cycles_get_network (SEXP network)
+{
+    external_pointer <Network> ptr (network);
+    if (ptr.get () == nullptr)
+        cpp11::stop ("Network is no longer valid; it must be rebuilt");
+    return *ptr;
+}
+
+// Convert 1-based R indices to network edge indices, checking bounds.
+void cycles_edge_indices (const integers &edges_in,
+        const Network &network,
+        std::vector <index_t> &edges)
 {
-    T1 s = df [col];
-    result.resize (static_cast <size_t> (s.size ()));
-    std::copy (s.begin (), s.end (), result.begin ());
+    edges.resize (static_cast <size_t> (edges_in.size ()));
+    for (R_xlen_t i = 0; i < edges_in.size (); i++)
+    {
+        const int e = edges_in [i];
+        if (e < 1 || static_cast <size_t> (e) > network.edges.size ())
+            cpp11::stop ("Edge indices must be within the network");
+        edges [static_cast <size_t> (i)] = static_cast <index_t> (e - 1);
+    }
 }
 
+// Build a network from the data.frame passed from R, returned as an external
+// pointer which can be passed to all subsequent calls.
 [[cpp11::register]]
-writable::list cycles_cpp(list df, strings edge_list,
-        const int start_edge_index, const bool left)
+SEXP cpp_network(list df)
+{
+    stats::PhaseTimer timer ("build_network");
+
+    NetworkColumns cols;
+    ingest::network_columns (df, cols);
+
+    std::unique_ptr <Network> network (new Network);
+    build_network::fill_network (*network, cols);
+
+    external_pointer <Network> ptr (network.release ());
+
+    return ptr;
+}
+
+// Convert paths to list of 1-based indices into network edges, with canonical
+// cycle keys as an attribute, "keys".
+writable::list cycles_paths_to_list (
+        const std::vector <std::vector <index_t> > &paths,
+        const std::vector <CycleKey> &keys)
 {
+    cpp11::writable::list paths_out (static_cast <R_xlen_t> (paths.size ()));
 
-    std::vector <std::string> edges;
-    std::vector <std::string> v0;
-    std::vector <std::string> v1;
-    std::vector <double> x0;
-    std::vector <double> y0;
-    std::vector <double> x1;
-    std::vector <double> y1;
-
-    cycles_copy_column <strings, std::string> (df, "edge_", edges);
-    cycles_copy_column <strings, std::string> (df, ".vx0", v0);
-    cycles_copy_column <strings, std::string> (df, ".vx1", v1);
-    cycles_copy_column <doubles, double> (df, ".vx0_x", x0);
-    cycles_copy_column <doubles, double> (df, ".vx0_y", y0);
-    cycles_copy_column <doubles, double> (df, ".vx1_x", x1);
-    cycles_copy_column <doubles, double> (df, ".vx1_y", y1);
-
-    Network network;
-    build_network::fill_network (network, edges, v0, v1,
-            x0, y0, x1, y1);
-
-    PathData pathData;
-    build_network::fillPathEdges (network, pathData);
-
-    PathEdgeSet path_edges;
-    std::unordered_set <size_t> path_hashes;
-    cycles::trace_edge_set (pathData, path_edges, network, left, path_hashes);
-
-    next_cycle::single_edges (path_edges, pathData);
-    cycles::trace_edge_set (pathData, path_edges, network, left, path_hashes);
-
-    // return value is index into network edges obtained directly from edge_map
-    cpp11::writable::list paths_out (static_cast <R_xlen_t> (path_edges.size ()));
-
-    int i = 0;
-    for (auto pe: path_edges)
+    R_xlen_t i = 0;
+    for (const auto &pe: paths)
     {
         cpp11::writable::integers edge_index (static_cast <R_xlen_t> (pe.size ()));
-        int j = 0;
+        R_xlen_t j = 0;
         for (auto p: pe) {
-            edge_index [j++] = static_cast <int> (network.edge_map.at (p)) + 1L;
+            edge_index [j++] = static_cast <int> (p) + 1L;
         }
         paths_out [i++] = edge_index;
     }
-                
+
+    cpp11::writable::strings keys_out (static_cast <R_xlen_t> (keys.size ()));
+    for (size_t k = 0; k < keys.size (); k++)
+        keys_out [static_cast <R_xlen_t> (k)] = keys [k].to_string ();
+    paths_out.attr ("keys") = keys_out;
+
     return paths_out;
 }
 
+// Trace cycles in one direction from the 'start' edges, through the network
+// restricted to 'active' edges. Edge indices in cycles index the full network.
+[[cpp11::register]]
+writable::list cycles_cpp(SEXP network, logicals active, integers start,
+        const bool left, const int nthreads)
+{
+    stats::PhaseTimer timer ("trace_cycles");
+
+    const Network &net = cycles_get_network (network);
+    if (static_cast <size_t> (active.size ()) != net.edges.size ())
+        cpp11::stop ("'active' must have one value for each network edge");
+
+    // NA values are inactive:
+    const int *active_in = LOGICAL (active);
+    std::vector <bool> active_edges (net.edges.size ());
+    for (size_t i = 0; i < active_edges.size (); i++)
+        active_edges [i] = active_in [i] == TRUE;
+
+    std::vector <index_t> start_edges;
+    cycles_edge_indices (start, net, start_edges);
+    start_edges.erase (std::remove_if (start_edges.begin (), start_edges.end (),
+                [&active_edges] (index_t e) { return !active_edges [e]; }),
+            start_edges.end ());
+
+    Network masked;
+    build_network::mask_network (net, active_edges, masked);
+
+    std::vector <std::vector <index_t> > paths;
+    std::vector <CycleKey> keys;
+    cycles::trace_network (masked, start_edges, paths, keys, left, nthreads);
+
+    return cycles_paths_to_list (paths, keys);
+}
+
+// Trace left and right cycles concurrently, returning a list of two lists of
+// cycles.
+[[cpp11::register]]
+writable::list cycles_lr_cpp(SEXP network, const int nthreads)
+{
+    stats::PhaseTimer timer ("trace_left_right");
+
+    const Network &net = cycles_get_network (network);
+
+    std::vector <index_t> start (net.edges.size ());
+    std::iota (start.begin (), start.end (), 0);
+
+    std::vector <std::vector <index_t> > paths_left, paths_right;
+    std::vector <CycleKey> keys_left, keys_right;
+    cycles::trace_left_right (net, start, paths_left, paths_right,
+            keys_left, keys_right, nthreads);
+
+    writable::list res (2);
+    res [0] = cycles_paths_to_list (paths_left, keys_left);
+    res [1] = cycles_paths_to_list (paths_right, keys_right);
+
+    return res;
+}
+
+// Merge a list of lists of cycles, each of 1-based indices into network edges,
+// retaining in order only those cycles with undirected edges which differ from
+// all preceding cycles.
+[[cpp11::register]]
+writable::list cycles_merge_cpp(SEXP network, list edge_lists)
+{
+    stats::PhaseTimer timer ("merge_cycles");
+
+    const Network &net = cycles_get_network (network);
+
+    std::vector <std::vector <std::vector <index_t> > > path_sets (
+            static_cast <size_t> (edge_lists.size ()));
+    for (size_t i = 0; i < path_sets.size (); i++)
+    {
+        list paths_in = edge_lists [static_cast <R_xlen_t> (i)];
+        path_sets [i].resize (static_cast <size_t> (paths_in.size ()));
+        for (size_t j = 0; j < path_sets [i].size (); j++)
+        {
+            integers p = paths_in [static_cast <R_xlen_t> (j)];
+            cycles_edge_indices (p, net, path_sets [i] [j]);
+        }
+    }
+
+    std::vector <std::vector <index_t> > paths;
+    std::vector <CycleKey> keys;
+    cycles::merge_paths (net, path_sets, paths, keys);
+
+    return cycles_paths_to_list (paths, keys);
+}
+
+// Identify isolated polygons in a list of 1-based edge indices of paths
+// through the network. Return value is a list of two items: a logical vector
+// flagging isolated paths, and a logical vector flagging all network edges
+// which remain after removing isolated polygons and any resultant dangling
+// edges.
+[[cpp11::register]]
+writable::list cpp_isolated_polygons(SEXP network, list paths_in)
+{
+    stats::PhaseTimer timer ("isolated_polygons");
+
+    const Network &net = cycles_get_network (network);
+
+    const size_t n = static_cast <size_t> (paths_in.size ());
+    std::vector <std::vector <index_t> > paths (n);
+    for (size_t i = 0; i < n; i++)
+    {
+        integers p = paths_in [static_cast <R_xlen_t> (i)];
+        cycles_edge_indices (p, net, paths [i]);
+    }
+
+    std::vector <bool> path_isolated, keep;
+    isolated::isolated_polygons (net, paths, path_isolated, keep);
+
+    writable::logicals isolated_out (static_cast <R_xlen_t> (n));
+    for (size_t i = 0; i < n; i++)
+        isolated_out [static_cast <R_xlen_t> (i)] = path_isolated [i];
+    writable::logicals keep_out (static_cast <R_xlen_t> (keep.size ()));
+    for (size_t i = 0; i < keep.size (); i++)
+        keep_out [static_cast <R_xlen_t> (i)] = keep [i];
+
+    writable::list res (2);
+    res [0] = isolated_out;
+    res [1] = keep_out;
+
+    return res;
+}
+
+// Enumerate all faces of a planar network in a single pass, or with 'tiles' >
+// 1, in parallel over 'tiles' x 'tiles' spatial tiles, with identical
+// results. Return value is a list of indices into network edges for each
+// face, with an attribute, "outer", flagging unbounded faces.
+[[cpp11::register]]
+writable::list cpp_faces(SEXP network, const int tiles, const int nthreads)
+{
+    stats::PhaseTimer timer ("faces");
+
+    const Network &net = cycles_get_network (network);
+
+    FaceData faces;
+    faces::enumerate_tiled (net, static_cast <size_t> (std::max (tiles, 1)),
+            nthreads, faces);
+
+    const size_t nfaces = faces.area.size ();
+    cpp11::writable::list faces_out (static_cast <R_xlen_t> (nfaces));
+    cpp11::writable::logicals outer (static_cast <R_xlen_t> (nfaces));
+
+    for (size_t i = 0; i < nfaces; i++)
+    {
+        const index_t from = faces.offsets [i], to = faces.offsets [i + 1];
+        cpp11::writable::integers edge_index (static_cast <R_xlen_t> (to - from));
+        for (index_t j = from; j < to; j++)
+            edge_index [static_cast <R_xlen_t> (j - from)] =
+                static_cast <int> (faces.edges [j]) + 1L;
+        faces_out [static_cast <R_xlen_t> (i)] = edge_index;
+        outer [static_cast <R_xlen_t> (i)] = faces.area [i] <= 0.0;
+    }
+
+    faces_out.attr ("outer") = outer;
+
+    return faces_out;
+}
+
+// Identify all paths which are supersets of any smaller paths.
 [[cpp11::register]]
-writable::logicals cpp_reduce_paths(list edge_list)
+writable::logicals cpp_reduce_paths(list edge_list, const int nthreads)
 {
+    stats::PhaseTimer timer ("reduce_paths");
+
     const size_t n = static_cast <size_t> (edge_list.size ());
     std::vector <size_t> n_edges (n);
     for (size_t i = 0; i < n; i++)
@@ -86,31 +259,18 @@ writable::logicals cpp_reduce_paths(list edge_list)
     std::vector <size_t> sorted = utils::sort_indexes <size_t> (n_edges);
     // sorted is in increasing order
 
-    std::vector <std::unordered_set <int> > edge_sets (n);
+    std::vector <std::vector <int> > edge_sets (n);
     for (size_t i = 0; i < n; i++)
     {
         integers edges = edge_list [sorted [i]];
-        for (auto e: edges)
-        {
-            edge_sets [i].emplace (e);
-        }
+        edge_sets [i].assign (edges.begin (), edges.end ());
     }
     // edge_sets are sorted in order of increasing size
 
-    std::vector <bool> dupl_vec (n, false);
-    for (size_t i = 0; i < (n - 1); i++)
-    {
-        for (size_t j = (i + 1); j < n; j++)
-        {
-            bool all_in_j = true;
-            for (auto e: edge_sets [i])
-            {
-                all_in_j = all_in_j && edge_sets [j].count (e) > 0;
-            }
-            if (all_in_j)
-                dupl_vec [j] = true;
-        }
-    }
+    std::vector <bool> dupl_vec;
+    reduce_paths::superset_paths (edge_sets, dupl_vec, nthreads);
+    stats::add (stats::SUPERSET_PATHS, static_cast <std::uint64_t> (
+                std::count (dupl_vec.begin (), dupl_vec.end (), true)));
 
     // re-order duplicated to match original edge_list order
     writable::logicals duplicated (static_cast <R_xlen_t> (n));
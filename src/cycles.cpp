@@ -1,331 +1,626 @@
 #include "cycles.h"
+#include "threads.h"
 #include <stdexcept>
 #include <unordered_set>
+#include <cstdio> // snprintf
+
+// Two fixed seeds for the independent halves of 'CycleKey' values:
+const std::uint64_t CYCLE_KEY_SEED1 = 0x243f6a8885a308d3ULL;
+const std::uint64_t CYCLE_KEY_SEED2 = 0x13198a2e03707344ULL;
+
+// Key as a 32-character hexadecimal string.
+std::string CycleKey::to_string () const
+{
+    char buf [33];
+    std::snprintf (buf, sizeof (buf), "%016llx%016llx",
+            static_cast <unsigned long long> (h1),
+            static_cast <unsigned long long> (h2));
+    return std::string (buf);
+}
 
 void build_network::fill_network (Network &network,
-        const std::vector <std::string> edges,
-        const std::vector <std::string> v0,
-        const std::vector <std::string> v1,
-        const std::vector <double> x0,
-        const std::vector <double> y0,
-        const std::vector <double> x1,
-        const std::vector <double> y1)
+        const NetworkColumns &cols)
 {
 
-    const size_t n = edges.size ();
+    const size_t n = cols.edge_ids.size ();
 
     network.edges.resize (n);
+    network.n_verts = cols.n_verts;
+    network.vert_named = cols.vert_named;
+    network.edge_undir.resize (n);
+    network.undir_key.clear ();
+
+    std::unordered_map <CharView, index_t, CharViewHash> undir_map;
+    undir_map.reserve (n);
 
     for (size_t i = 0; i < n; i++)
     {
-
-        network.edges [i].edge = edges [i];
-        network.edges [i].v0 = v0 [i];
-        network.edges [i].v1 = v1 [i];
-
-        network.edges [i].x0 = x0 [i];
-        network.edges [i].y0 = y0 [i];
-        network.edges [i].x1 = x1 [i];
-        network.edges [i].y1 = y1 [i];
-
-        network.edge_map.emplace (edges [i], i);
-
-        std::vector <size_t> v0_vec;
-        if (network.v0_map.count (v0 [i]) > 0)
+        network.edges [i].edge = static_cast <index_t> (i);
+        network.edges [i].v0 = cols.v0 [i];
+        network.edges [i].v1 = cols.v1 [i];
+
+        network.edges [i].x0 = cols.x0 [i];
+        network.edges [i].y0 = cols.y0 [i];
+        network.edges [i].x1 = cols.x1 [i];
+        network.edges [i].y1 = cols.y1 [i];
+
+        const CharView this_edge = utils::cut_terminal_rev (cols.edge_ids [i]);
+        auto it = undir_map.emplace (this_edge,
+                static_cast <index_t> (undir_map.size ()));
+        network.edge_undir [i] = it.first->second;
+        if (it.second)
         {
-            v0_vec = network.v0_map.at (v0 [i]);
-            network.v0_map.erase (v0 [i]);
+            // Keys depend only on the IDs, so are the same for any network
+            // containing the same edges:
+            CycleKey k;
+            k.h1 = utils::hash_chars (this_edge.s, this_edge.len,
+                    CYCLE_KEY_SEED1);
+            k.h2 = utils::hash_chars (this_edge.s, this_edge.len,
+                    CYCLE_KEY_SEED2);
+            network.undir_key.push_back (k);
         }
-        v0_vec.push_back (i);
-        network.v0_map.emplace (v0 [i], v0_vec);
+    } // end for i
 
-        std::vector <size_t> v1_vec;
-        if (network.v1_map.count (v1 [i]) > 0)
+    network.n_undir = static_cast <index_t> (undir_map.size ());
+
+    // Pair each edge with its reverse, which has the same undirected ID:
+    network.edge_twin.assign (n, INFINITE_INDEX);
+    std::vector <index_t> undir_first (network.n_undir, INFINITE_INDEX);
+    for (index_t i = 0; i < n; i++)
+    {
+        const index_t j = undir_first [network.edge_undir [i]];
+        if (j == INFINITE_INDEX)
+        {
+            undir_first [network.edge_undir [i]] = i;
+        } else if (network.edges [j].v0 == network.edges [i].v1 &&
+                network.edges [j].v1 == network.edges [i].v0)
         {
-            v1_vec = network.v1_map.at (v1 [i]);
-            network.v1_map.erase (v1 [i]);
+            network.edge_twin [i] = j;
+            network.edge_twin [j] = i;
         }
-        v1_vec.push_back (i);
-        network.v1_map.emplace (v1 [i], v1_vec);
-    } // end for i
-}
+    }
 
-void build_network::fillPathEdges (const Network &network,
-        PathData &pathData)
-{
-    pathData.edgeList.clear ();
-    for (auto e: network.edges)
-        pathData.edgeList.emplace (e.edge);
+    network.edge_order.resize (n);
+    std::iota (network.edge_order.begin (), network.edge_order.end (), 0);
+    const std::vector <CharView> &edge_ids = cols.edge_ids;
+    std::sort (network.edge_order.begin (), network.edge_order.end (),
+            [&edge_ids] (index_t i, index_t j) {
+                return edge_ids [i] < edge_ids [j]; });
+    network.edge_rank.resize (n);
+    for (size_t i = 0; i < n; i++)
+        network.edge_rank [network.edge_order [i]] = static_cast <index_t> (i);
+
+    build_network::fill_rotation (network);
 }
 
-std::string cycles::nextPathEdge (PathData &pathData)
+// Order of outgoing edges in the rotation system, anticlockwise by angle,
+// with ties broken by edge index.
+bool build_network::rotation_less (const EdgeVec &edges,
+        const index_t i,
+        const index_t j)
 {
-    auto nextEdgeItr = pathData.edgeList.begin ();
-    std::string nextEdge = *nextEdgeItr;
-    pathData.edgeList.erase (nextEdgeItr);
-
-    return nextEdge;
+    const OneEdge &ei = edges [i], &ej = edges [j];
+    if (clockwise::less_angle (ei.x1 - ei.x0, ei.y1 - ei.y0,
+                ej.x1 - ej.x0, ej.y1 - ej.y0))
+        return true;
+    if (clockwise::less_angle (ej.x1 - ej.x0, ej.y1 - ej.y0,
+                ei.x1 - ei.x0, ei.y1 - ei.y0))
+        return false;
+    return i < j;
 }
 
-std::vector <size_t> cycles::get_nbs (const Network &network,
-        const size_t this_edge)
+// Sort the outgoing edges of each vertex by angle, and pre-compute the next
+// edges to the left and right of each edge, so that tracing paths requires no
+// further geometric calculations. If 'active' is not empty, only edges flagged
+// there are included in the rotation system, and inactive edges have no next
+// edges.
+void build_network::fill_rotation (Network &network,
+        const std::vector <bool> &active)
 {
-    const std::string v0 = network.edges [this_edge].v0;
-    const std::string v1 = network.edges [this_edge].v1;
-
-    // Get all edges which have v0 == this_edge.v1:
-    const std::vector <size_t> v1_nbs = network.v0_map.at (v1); 
+    const size_t n = network.edges.size ();
+    const size_t nverts = network.n_verts;
+    const bool all_active = active.empty ();
 
-    bool v1_has_v0 = false;
-    for (auto i: v1_nbs)
+    network.out_offset.assign (nverts + 1, 0L);
+    for (auto e: network.edges)
     {
-        if (network.edges [i].v1 == v0)
-        {
-            v1_has_v0 = true;
-            break;
-        }
+        if (all_active || active [e.edge])
+            network.out_offset [e.v0 + 1]++;
     }
+    for (size_t i = 0; i < nverts; i++)
+        network.out_offset [i + 1] += network.out_offset [i];
 
-    size_t nnbs = v1_nbs.size ();
-    // plus remove reverse edges which point back to same v0
-    if (v1_has_v0)
-        nnbs--;
+    network.out_edges.resize (network.out_offset.back ());
+    std::vector <index_t> pos (network.out_offset.begin (),
+            network.out_offset.end () - 1);
+    for (index_t i = 0; i < n; i++)
+    {
+        if (all_active || active [i])
+            network.out_edges [pos [network.edges [i].v0]++] = i;
+    }
 
+    const EdgeVec &edges = network.edges;
+    for (size_t v = 0; v < nverts; v++)
+    {
+        std::sort (network.out_edges.begin () + network.out_offset [v],
+                network.out_edges.begin () + network.out_offset [v + 1],
+                [&edges] (index_t i, index_t j) {
+                    return build_network::rotation_less (edges, i, j); });
+    }
 
-    std::vector <size_t> nbs (nnbs);
+    network.next_left.assign (n, INFINITE_INDEX);
+    network.next_right.assign (n, INFINITE_INDEX);
+    for (index_t i = 0; i < n; i++)
+    {
+        if (!all_active && !active [i])
+            continue;
+        network.next_left [i] = build_network::next_edge (network, i, true);
+        network.next_right [i] = build_network::next_edge (network, i, false);
+    }
+}
 
-    if (nnbs == 0)
-        return nbs;
+// Copy a network restricted to the edges flagged in 'active'. Edge indices are
+// unchanged, so paths through the masked network index the original edges.
+void build_network::mask_network (const Network &network,
+        const std::vector <bool> &active,
+        Network &masked)
+{
+    masked = network;
+    build_network::fill_rotation (masked, active);
+}
 
-    size_t count = 0;
-    for (auto i: v1_nbs)
+// Find the next edge from the end of 'this_edge' which turns maximally to the
+// left or right, excluding edges which return to the start vertex:
+// - With 'left = true', this is the first outgoing edge encountered when
+// rotating clockwise from the direction back along 'this_edge', which is the
+// most anticlockwise turn, stored in 'next_left'.
+// - With 'left = false', this is the first outgoing edge encountered when
+// rotating anticlockwise from the direction back along 'this_edge', which is
+// the most clockwise turn, stored in 'next_right'.
+// Edges pointing straight back along 'this_edge' are only taken as a last
+// resort.
+index_t build_network::next_edge (const Network &network,
+        const index_t this_edge,
+        const bool left)
+{
+    const OneEdge &e = network.edges [this_edge];
+    const double bx = e.x0 - e.x1;
+    const double by = e.y0 - e.y1;
+
+    auto first = network.out_edges.begin () + network.out_offset [e.v1];
+    auto last = network.out_edges.begin () + network.out_offset [e.v1 + 1];
+    const size_t nout = static_cast <size_t> (last - first);
+    if (nout == 0)
+        return INFINITE_INDEX;
+
+    // Outgoing edges are sorted by angle, so partition into those with angles
+    // less than the back direction (for left), or less than or equal to (for
+    // right):
+    const EdgeVec &edges = network.edges;
+    auto back = std::partition_point (first, last,
+            [&edges, bx, by, left] (index_t j) {
+                const OneEdge &ej = edges [j];
+                const double ex = ej.x1 - ej.x0, ey = ej.y1 - ej.y0;
+                return left ? clockwise::less_angle (ex, ey, bx, by) :
+                    !clockwise::less_angle (bx, by, ex, ey);
+            });
+    size_t i = static_cast <size_t> (back - first);
+    if (!left)
+        i = (i + nout - 1) % nout;
+
+    for (size_t count = 0; count < nout; count++)
     {
-        if (network.edges [i].v1 != v0)
-            nbs [count++] = i;
+        i = left ? (i + nout - 1) % nout : (i + 1) % nout;
+        const index_t j = network.out_edges [network.out_offset [e.v1] + i];
+        if (network.edges [j].v1 != e.v0)
+            return j;
     }
 
-    return nbs;
+    return INFINITE_INDEX;
+}
+
+void build_network::fillPathEdges (const Network &network,
+        PathData &pathData,
+        const std::vector <index_t> &edges)
+{
+    pathData.edgeList.clear ();
+    for (auto e: edges)
+        pathData.edgeList.emplace (network.edge_rank [e]);
+
+    pathData.stamp = 0;
+    pathData.vert_stamp.assign (network.n_verts, 0L);
+    pathData.vert_pos.resize (network.n_verts);
+    pathData.undir_stamp.assign (network.n_undir, 0L);
+    pathData.undir_count.resize (network.n_undir);
+}
+
+index_t cycles::nextPathEdge (const Network &network, PathData &pathData)
+{
+    auto nextEdgeItr = pathData.edgeList.begin ();
+    index_t nextEdge = network.edge_order [*nextEdgeItr];
+    pathData.edgeList.erase (nextEdgeItr);
+
+    return nextEdge;
 }
 
 bool cycles::increment_cycle (const Network &network,
         PathData &pathData,
-        const std::string &start_edge,
+        const index_t start_edge,
         const bool left,
         const bool start)
 {
-    size_t edge_i;
+    const index_t edge_i = start ? start_edge : pathData.left_nb;
 
-    if (start)
-    {
-        if (network.edge_map.find (start_edge) ==
-                network.edge_map.end ())
-            cpp11::stop ("edge not found");
+    if (edge_i == INFINITE_INDEX)
+        return false;
 
-        edge_i = network.edge_map.at (start_edge);
-    } else
+    // Mark start vertex as visited, and check whether end vertex has been
+    // visited, which means path connects back on itself:
+    const OneEdge &this_edge = network.edges [edge_i];
+    if (pathData.vert_stamp [this_edge.v0] != pathData.stamp)
     {
-        edge_i = pathData.left_nb;
+        pathData.vert_stamp [this_edge.v0] = pathData.stamp;
+        pathData.vert_pos [this_edge.v0] =
+            static_cast <index_t> (pathData.path.size ());
     }
-    if (edge_i == INFINITE_INT)
-        return false;
-
-    OneEdge this_edge = network.edges [static_cast <size_t> (edge_i)];
-    pathData.path.push_back (this_edge);
+    if (pathData.loop_vert == INFINITE_INT &&
+            pathData.vert_stamp [this_edge.v1] == pathData.stamp)
+        pathData.loop_vert = pathData.path.size ();
 
-    std::vector <size_t> nbs = cycles::get_nbs (network, edge_i);
-    pathData.left_nb = INFINITE_INT;
+    pathData.path.push_back (edge_i);
+    pathData.n_visited++;
+    cycles::add_path_edge (network, pathData, edge_i);
 
-    if (nbs.size () > 0)
-    {
-        if (nbs.size () == 1)
-        {
-            pathData.left_nb = nbs [0];
-        } else
-        {
-            std::vector <double> nbs_x (nbs.size ());
-            std::vector <double> nbs_y (nbs.size ());
-            for (size_t i = 0; i < nbs.size (); i++)
-            {
-                nbs_x [i] = network.edges [nbs [i]].x1;
-                nbs_y [i] = network.edges [nbs [i]].y1;
-            }
-            size_t lefty = clockwise::to_left (
-                    this_edge.x0,
-                    this_edge.y0,
-                    this_edge.x1,
-                    this_edge.y1,
-                    nbs_x, nbs_y, left);
-            pathData.left_nb = nbs [lefty];
-        }
-    }
+    pathData.left_nb = left ? network.next_left [edge_i] :
+        network.next_right [edge_i];
 
     return true;
 }
 
-//' Determine the index where the path connects back on itself.
-size_t cycles::path_loop_vert (const PathData &pathData)
+// Start a new trace, invalidating all previous vertex marks in O(1) time.
+void cycles::new_trace (const Network &network, PathData &pathData)
 {
-    std::unordered_set <std::string> pathVerts;
+    pathData.path.clear ();
+    pathData.loop_vert = INFINITE_INT;
+    pathData.key = CycleKey ();
 
-    size_t loop_vert = INFINITE_INT;
+    if (pathData.vert_stamp.size () != network.n_verts ||
+            pathData.undir_stamp.size () != network.n_undir)
+    {
+        pathData.vert_stamp.assign (network.n_verts, 0L);
+        pathData.vert_pos.resize (network.n_verts);
+        pathData.undir_stamp.assign (network.n_undir, 0L);
+        pathData.undir_count.resize (network.n_undir);
+        pathData.stamp = 0;
+    }
 
-    size_t count = 0;
-    for (auto p: pathData.path)
+    pathData.stamp++;
+    if (pathData.stamp == INFINITE_INDEX)
     {
-        pathVerts.emplace (p.v0);
-        if (pathVerts.find (p.v1) != pathVerts.end ())
-        {
-            loop_vert = count;
-            break;
-        }
-        count++;
+        std::fill (pathData.vert_stamp.begin (), pathData.vert_stamp.end (), 0L);
+        std::fill (pathData.undir_stamp.begin (), pathData.undir_stamp.end (), 0L);
+        pathData.stamp = 1;
     }
+}
 
-    return loop_vert;
+//' Determine the index where the path connects back on itself. This is
+//' updated by each call to 'increment_cycle'.
+size_t cycles::path_loop_vert (const PathData &pathData)
+{
+    return pathData.loop_vert;
 }
 
-void cycles::trace_cycle (const Network &network,
+// Trace a cycle from the next start edge, returning false if the path ends
+// without connecting back on itself.
+bool cycles::trace_cycle (const Network &network,
         PathData &pathData,
         const bool left)
 {
-    pathData.path.clear ();
+    cycles::new_trace (network, pathData);
 
-    bool check = false;
-    while (!check)
-    {
-        std::string nextEdge = cycles::nextPathEdge (pathData);
-        check = cycles::increment_cycle (network, pathData, nextEdge, left, true);
-    }
+    const index_t nextEdge = cycles::nextPathEdge (network, pathData);
+    bool check = cycles::increment_cycle (network, pathData, nextEdge, left, true);
 
-    size_t loop_vert = INFINITE_INT;
-    while (loop_vert == INFINITE_INT)
+    while (check && cycles::path_loop_vert (pathData) == INFINITE_INT)
     {
-        check = false;
-        while (!check)
-        {
-            check = cycles::increment_cycle (network, pathData, "", left, false);
-
-            if (!check)
-                check = (pathData.edgeList.size () == 0);
-        }
-        loop_vert = cycles::path_loop_vert (pathData);
-        if (pathData.edgeList.size () == 0)
-            loop_vert = 0;
+        check = cycles::increment_cycle (network, pathData,
+                INFINITE_INDEX, left, false);
     }
 
     // remove path edges from startEdge candidates:
     for (auto p: pathData.path)
-    {
-        if (pathData.edgeList.find (p.edge) !=
-                pathData.edgeList.end ())
-            pathData.edgeList.erase (p.edge);
-    }
+        pathData.edgeList.erase (network.edge_rank [p]);
 
-    cycles::cut_path (pathData);
+    if (check)
+        cycles::cut_path (network, pathData);
+
+    return check;
 }
 
-void cycles::cut_path (PathData &pathData)
+// Cut the path to start at the first vertex which equals the final vertex.
+void cycles::cut_path (const Network &network, PathData &pathData)
 {
-    std::string lastVert = pathData.path.back ().v1;
-
-    size_t loop_vert = INFINITE_INT;
+    const index_t lastVert = network.edges [pathData.path.back ()].v1;
 
-    size_t count = 0;
-    for (auto p: pathData.path)
+    if (pathData.vert_stamp [lastVert] == pathData.stamp)
     {
-        if (p.v0 == lastVert)
-        {
-            loop_vert = count;
-            break;
-        }
-        count++;
+        const index_t loop_vert = pathData.vert_pos [lastVert];
+        for (index_t i = 0; i < loop_vert; i++)
+            cycles::remove_path_edge (network, pathData, pathData.path [i]);
+        pathData.path.erase (pathData.path.begin (),
+                pathData.path.begin () + loop_vert);
     }
+}
 
-    if (loop_vert != INFINITE_INT)
+// Add an edge to the canonical key of the current path, if the undirected
+// edge is not already in the path.
+void cycles::add_path_edge (const Network &network,
+        PathData &pathData,
+        const index_t edge)
+{
+    const index_t u = network.edge_undir [edge];
+    if (pathData.undir_stamp [u] != pathData.stamp)
     {
-        for (size_t i = 0; i < loop_vert; i++)
-            pathData.path.erase (pathData.path.begin ());
+        pathData.undir_stamp [u] = pathData.stamp;
+        pathData.undir_count [u] = 0;
     }
+    if (pathData.undir_count [u]++ == 0)
+        pathData.key += network.undir_key [u];
 }
 
+// Remove an edge from the canonical key of the current path, if no other
+// instance of the undirected edge remains in the path.
+void cycles::remove_path_edge (const Network &network,
+        PathData &pathData,
+        const index_t edge)
+{
+    const index_t u = network.edge_undir [edge];
+    if (--pathData.undir_count [u] == 0)
+        pathData.key -= network.undir_key [u];
+}
 
-size_t cycles::path_hash (const PathData &pathData)
+// Sorted set of unique undirected edges in a path.
+void cycles::undir_edges (const Network &network,
+        const std::vector <index_t> &path,
+        std::vector <index_t> &edges)
 {
-    // first get the ordered edge_set
-    std::set <std::string> edge_set;
-    for (auto p: pathData.path)
+    edges.clear ();
+    edges.reserve (path.size ());
+    for (auto p: path)
+        edges.push_back (network.edge_undir [p]);
+    std::sort (edges.begin (), edges.end ());
+    edges.erase (std::unique (edges.begin (), edges.end ()), edges.end ());
+}
+
+// Insert a path, returning false if the set already has a path with the same
+// undirected edges.
+bool CycleSet::insert (const Network &network,
+        const CycleKey &key,
+        const std::vector <index_t> &path)
+{
+    const size_t i = CycleKeyHash () (key) % nlocks;
+    std::lock_guard <std::mutex> lock (locks [i]);
+
+    auto it = cycles [i].find (key);
+    if (it == cycles [i].end ())
     {
-        std::string this_edge = p.edge;
-        utils::cut_terminal_rev (this_edge);
-        edge_set.emplace (this_edge);
+        cycles [i].emplace (key, std::vector <std::vector <index_t> > {path});
+        stats::add (stats::CYCLES_INSERTED, 1);
+        return true;
     }
 
-    // then construct the hash from the full set
-    std::hash <std::string> hasher;
-
-    size_t h = 0; // the hash
-    for (auto e: edge_set)
+    // Equal keys are almost always equal cycles, but check exactly:
+    std::vector <index_t> set_new, set_old;
+    cycles::undir_edges (network, path, set_new);
+    for (auto &p: it->second)
     {
-        h ^= hasher (e) + 0x9e3779b9 + (h<<6) + (h>>2);
+        cycles::undir_edges (network, p, set_old);
+        if (set_old == set_new)
+        {
+            if (path < p)
+                p = path;
+            stats::add (stats::CYCLES_DUPLICATE, 1);
+            return false;
+        }
     }
+    it->second.push_back (path);
+    stats::add (stats::CYCLES_INSERTED, 1);
+    stats::add (stats::KEY_COLLISIONS, 1);
+    return true;
+}
 
-    return h;
+// Return all paths sorted in lexicographic order, along with their keys.
+void CycleSet::get_paths (std::vector <std::vector <index_t> > &paths,
+        std::vector <CycleKey> &keys) const
+{
+    std::vector <std::pair <std::vector <index_t>, CycleKey> > res;
+    for (size_t i = 0; i < nlocks; i++)
+    {
+        for (const auto &c: cycles [i])
+        {
+            for (const auto &p: c.second)
+                res.emplace_back (p, c.first);
+        }
+    }
+    std::sort (res.begin (), res.end (),
+            [] (const std::pair <std::vector <index_t>, CycleKey> &a,
+                const std::pair <std::vector <index_t>, CycleKey> &b) {
+                return a.first < b.first; });
+    stats::set_max (stats::CYCLE_SET_MAX, res.size ());
+
+    paths.clear ();
+    keys.clear ();
+    paths.reserve (res.size ());
+    keys.reserve (res.size ());
+    for (auto &r: res)
+    {
+        paths.push_back (std::move (r.first));
+        keys.push_back (r.second);
+    }
 }
 
-void cycles::trace_edge_set (PathData &pathData, PathEdgeSet &path_edges,
-        const Network &network, const bool left,
-        std::unordered_set <size_t> &path_hashes)
+// Trace cycles from all edges in 'pathData.edgeList'. Edges in each traced path
+// are removed from the list, because tracing from any of them leads to the
+// same cycle. Each cycle is rotated to start at its lowest edge index, so that
+// cycles are identical regardless of the edge from which they were traced.
+void cycles::trace_edge_set (PathData &pathData, CycleSet &cycle_set,
+        const Network &network, const bool left)
 {
+    std::uint64_t n_traces = 0, n_restarts = 0;
+    pathData.n_visited = 0;
 
-    while (pathData.edgeList.size () > 1)
+    while (pathData.edgeList.size () > 0)
     {
-        cycles::trace_cycle (network, pathData, left);
-
-        size_t h = cycles::path_hash (pathData);
-        if (path_hashes.count (h) == 0L)
+        n_traces++;
+        if (!cycles::trace_cycle (network, pathData, left))
         {
-            path_hashes.emplace (h);
-            std::vector <std::string> edges_i;
-            edges_i.reserve (pathData.path.size ());
-            for (auto p: pathData.path)
-                edges_i.push_back (p.edge);
-
-            path_edges.emplace (edges_i);
+            n_restarts++;
+            continue;
         }
+
+        std::rotate (pathData.path.begin (),
+                std::min_element (pathData.path.begin (), pathData.path.end ()),
+                pathData.path.end ());
+
+        cycle_set.insert (network, pathData.key, pathData.path);
     }
+
+    stats::add (stats::EDGES_VISITED, pathData.n_visited);
+    stats::add (stats::TRACES, n_traces);
+    stats::add (stats::TRACE_RESTARTS, n_restarts);
+}
+
+// Trace cycles from 'edges', split into contiguous chunks for each thread.
+// Because each cycle only depends on its start edge, and 'CycleSet' contents
+// do not depend on insertion order, results are independent of the number of
+// threads.
+void cycles::trace_parallel (const Network &network,
+        const std::vector <index_t> &edges,
+        CycleSet &cycle_set,
+        const bool left,
+        const int nthreads)
+{
+    std::vector <index_t> edges_sorted (edges);
+    std::sort (edges_sorted.begin (), edges_sorted.end (),
+            [&network] (index_t i, index_t j) {
+                return network.edge_rank [i] < network.edge_rank [j]; });
+
+    threads::parallel_for (edges_sorted.size (), nthreads,
+            [&] (size_t from, size_t to, size_t) {
+                const std::vector <index_t> edges_i (
+                        edges_sorted.begin () + static_cast <long> (from),
+                        edges_sorted.begin () + static_cast <long> (to));
+                PathData pathData;
+                build_network::fillPathEdges (network, pathData, edges_i);
+                cycles::trace_edge_set (pathData, cycle_set, network, left);
+            });
 }
 
-void next_cycle::single_edges (const PathEdgeSet &path_edges, PathData &pathData)
+// Trace all cycles of a network in one direction, first from all 'start'
+// edges, and then restarting from all edges which are only in one cycle.
+void cycles::trace_network (const Network &network,
+        const std::vector <index_t> &start,
+        std::vector <std::vector <index_t> > &paths,
+        std::vector <CycleKey> &keys,
+        const bool left,
+        const int nthreads)
 {
+    CycleSet cycle_set;
+    cycles::trace_parallel (network, start, cycle_set, left, nthreads);
+
+    std::vector <index_t> edges;
 
-    std::unordered_map <std::string, size_t> edge_count;
+    cycle_set.get_paths (paths, keys);
+    next_cycle::single_edges (network, paths, edges);
+    cycles::trace_parallel (network, edges, cycle_set, left, nthreads);
+
+    cycle_set.get_paths (paths, keys);
+}
 
-    for (auto path: path_edges)
+// Canonical key of the undirected edges of a path, equal to the key of the
+// path as traced.
+CycleKey cycles::path_key (const Network &network,
+        const std::vector <index_t> &path)
+{
+    std::vector <index_t> edges;
+    cycles::undir_edges (network, path, edges);
+    CycleKey key;
+    for (auto u: edges)
+        key += network.undir_key [u];
+    return key;
+}
+
+// Merge sets of paths in order, retaining only paths with undirected edges
+// which differ from those of all preceding paths. Paths are not reordered.
+void cycles::merge_paths (const Network &network,
+        const std::vector <std::vector <std::vector <index_t> > > &path_sets,
+        std::vector <std::vector <index_t> > &paths,
+        std::vector <CycleKey> &keys)
+{
+    CycleSet cycle_set;
+    paths.clear ();
+    keys.clear ();
+    for (const auto &ps: path_sets)
     {
-        for (auto p: path)
+        for (const auto &p: ps)
         {
-            std::string this_edge = p;
-            utils::cut_terminal_rev (this_edge);
-
-            size_t this_count = 0L;
-            if (edge_count.count (this_edge) > 0)
+            const CycleKey key = cycles::path_key (network, p);
+            if (cycle_set.insert (network, key, p))
             {
-                this_count = edge_count.at (this_edge);
-                this_count++;
-                edge_count.erase (this_edge);
+                paths.push_back (p);
+                keys.push_back (key);
             }
-            edge_count.emplace (this_edge, this_count);
         }
     }
+}
 
-    pathData.edgeList.clear ();
-    for (auto e: edge_count)
+// Trace left and right cycles concurrently, with threads split between them.
+void cycles::trace_left_right (const Network &network,
+        const std::vector <index_t> &start,
+        std::vector <std::vector <index_t> > &paths_left,
+        std::vector <std::vector <index_t> > &paths_right,
+        std::vector <CycleKey> &keys_left,
+        std::vector <CycleKey> &keys_right,
+        const int nthreads)
+{
+    const int nt = static_cast <int> (threads::n_threads (nthreads,
+                2 * start.size ()));
+    if (nt < 2)
     {
-        if (e.second == 0L)
-        {
-            pathData.edgeList.emplace (e.first);
-            pathData.edgeList.emplace (e.first + "_rev");
-        }
+        cycles::trace_network (network, start, paths_left, keys_left, true, 1);
+        cycles::trace_network (network, start, paths_right, keys_right, false,
+                1);
+        return;
+    }
+
+    const int nt_right = nt / 2;
+    std::thread right ([&network, &start, &paths_right, &keys_right,
+            nt_right] () {
+            cycles::trace_network (network, start, paths_right, keys_right,
+                    false, nt_right); });
+    cycles::trace_network (network, start, paths_left, keys_left, true,
+            nt - nt_right);
+    right.join ();
+}
+
+void next_cycle::single_edges (const Network &network,
+        const std::vector <std::vector <index_t> > &paths,
+        std::vector <index_t> &edges)
+{
+
+    std::vector <index_t> edge_count (network.n_undir, 0L);
+
+    for (const auto &path: paths)
+    {
+        for (auto p: path)
+            edge_count [network.edge_undir [p]]++;
     }
 
+    // Restart from both directions of all edges which are only in one path:
+    edges.clear ();
+    for (index_t i = 0; i < network.edges.size (); i++)
+    {
+        if (edge_count [network.edge_undir [i]] == 1L)
+            edges.push_back (i);
+    }
 }
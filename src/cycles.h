@@ -3,107 +3,249 @@
 #include "typedefs.h"
 #include "clockwise.h"
 #include "utils.h"
-
-#include "cpp11.hpp"
+#include "stats.h"
 
 #include <set>
-#include <iostream> // TODO: Remove that
+#include <mutex>
 #include <algorithm> // sort
 #include <cstring> // strcmp
 
 struct OneEdge
 {
     double x0, y0, x1, y1;
-    std::string v0;
-    std::string v1;
-    std::string edge;
+    index_t v0;
+    index_t v1;
+    index_t edge;
 };
 
 typedef std::vector <OneEdge> EdgeVec;
 
+// 128-bit canonical key of a cycle, as the sum of keys of each distinct
+// undirected edge. Keys are independent of the order of edges, and can be
+// updated as edges are added to or removed from a cycle. Equal keys do not
+// guarantee equal cycles, so are only used to find candidates for exact
+// comparison in 'CycleSet'.
+struct CycleKey
+{
+    std::uint64_t h1 = 0, h2 = 0;
+
+    CycleKey &operator+= (const CycleKey &k) {
+        h1 += k.h1;
+        h2 += k.h2;
+        return *this;
+    }
+    CycleKey &operator-= (const CycleKey &k) {
+        h1 -= k.h1;
+        h2 -= k.h2;
+        return *this;
+    }
+    bool operator== (const CycleKey &k) const {
+        return h1 == k.h1 && h2 == k.h2;
+    }
+
+    std::string to_string () const;
+};
+
+struct CycleKeyHash {
+
+    size_t operator() (const CycleKey &k) const {
+        return static_cast <size_t> (k.h1 ^ (k.h2 << 1));
+    }
+};
+
+// Input columns of a network, with vertex IDs interned to dense integer
+// indices, and edge IDs and coordinates held as views of data held elsewhere,
+// so that networks can be built without copying any strings.
+struct NetworkColumns
+{
+    index_t n_verts;
+    std::vector <index_t> v0;
+    std::vector <index_t> v1;
+    // false for vertices with empty IDs:
+    std::vector <bool> vert_named;
+    std::vector <CharView> vert_ids;
+    std::vector <CharView> edge_ids;
+    const double *x0;
+    const double *y0;
+    const double *x1;
+    const double *y1;
+};
+
+// All vertex and edge IDs are interned to dense integer indices when the
+// network is built, and no string IDs are retained.
 struct Network
 {
     EdgeVec edges;
-    // map from edge ID to network index
-    std::unordered_map <std::string, size_t> edge_map;
-    // maps from vertex IDs to network indices of all edges which start/end at
-    // that vertex:
-    std::unordered_map <std::string, std::vector <size_t> > v0_map;
-    std::unordered_map <std::string, std::vector <size_t> > v1_map;
+    index_t n_verts;
+    std::vector <bool> vert_named;
+    // index of undirected version of each edge, with "_rev" suffixes removed:
+    std::vector <index_t> edge_undir;
+    index_t n_undir;
+    // canonical key of each undirected edge, from hashes of the edge IDs:
+    std::vector <CycleKey> undir_key;
+    // index of reverse of each edge, or INFINITE_INDEX where there is none:
+    std::vector <index_t> edge_twin;
+    // Rotation system in compressed sparse row form: network indices of all
+    // edges which start at each vertex are in
+    // out_edges [out_offset [v]:(out_offset [v + 1] - 1)], sorted
+    // anticlockwise by angle.
+    std::vector <index_t> out_offset;
+    std::vector <index_t> out_edges;
+    // Next edge in a path turning maximally to the left or right from each
+    // edge, or INFINITE_INDEX where there is none:
+    std::vector <index_t> next_left;
+    std::vector <index_t> next_right;
+    // Edges in lexicographic order of edge IDs, and the inverse, so that
+    // edges are always traced in the same order as the string IDs:
+    std::vector <index_t> edge_order;
+    std::vector <index_t> edge_rank;
 };
 
 
 struct PathData
 {
-    std::set <std::string> edgeList; // list of edges to trace
-    EdgeVec path;
-    size_t left_nb;
+    std::set <index_t> edgeList; // ranks of edges to trace, from edge_rank
+    std::vector <index_t> path; // network indices of edges
+    // Next edge of the path, from 'next_left' when tracing left, or
+    // 'next_right' when tracing right:
+    index_t left_nb;
+    // Each trace increments 'stamp', with vertices marked as visited in the
+    // current trace by setting 'vert_stamp' to that value, so marks never need
+    // to be cleared. 'vert_pos' holds the position in the path where each
+    // vertex was first visited.
+    index_t stamp;
+    std::vector <index_t> vert_stamp;
+    std::vector <index_t> vert_pos;
+    size_t loop_vert; // first position where path connects back on itself
+    // Number of times each undirected edge is in the current path, and the
+    // canonical key of the distinct undirected edges:
+    std::vector <index_t> undir_stamp;
+    std::vector <index_t> undir_count;
+    CycleKey key;
+    // Number of edges added to paths in all traces, for 'stats':
+    std::uint64_t n_visited = 0;
 };
 
-struct VecHash {
+// Set of cycles keyed by 'CycleKey' values, which can be shared between
+// threads. Cycles with equal keys are compared exactly through their sets of
+// undirected edges, so distinct cycles are retained even if keys collide.
+// Where two cycles have the same undirected edges, the cycle which is
+// lexicographically smaller is retained, so that contents are always the same
+// regardless of the order of insertion.
+class CycleSet
+{
+    public:
 
-    size_t operator() (const std::vector<std::string>& v) const {
+        bool insert (const Network &network,
+                const CycleKey &key,
+                const std::vector <index_t> &path);
 
-        std::hash <std::string> hasher;
-        size_t seed = 0;
+        void get_paths (std::vector <std::vector <index_t> > &paths,
+                std::vector <CycleKey> &keys) const;
 
-        for (std::string i : v) {
-            seed ^= hasher(i) + 0x9e3779b9 + (seed<<6) + (seed>>2);
-        }
+    private:
 
-        return seed;
-    }
+        static const size_t nlocks = 64;
+        std::mutex locks [nlocks];
+        std::unordered_map <CycleKey, std::vector <std::vector <index_t> >,
+            CycleKeyHash> cycles [nlocks];
 };
 
-typedef std::unordered_set <std::vector <std::string>, VecHash> PathEdgeSet;
-
 namespace build_network {
 
-void fill_network (Network &network,
-        const std::vector <std::string> edges,
-        const std::vector <std::string> v0,
-        const std::vector <std::string> v1,
-        const std::vector <double> x0,
-        const std::vector <double> y0,
-        const std::vector <double> x1,
-        const std::vector <double> y1);
+void fill_network (Network &network, const NetworkColumns &cols);
+
+bool rotation_less (const EdgeVec &edges,
+        const index_t i,
+        const index_t j);
+
+void fill_rotation (Network &network,
+        const std::vector <bool> &active = std::vector <bool> ());
+
+void mask_network (const Network &network,
+        const std::vector <bool> &active,
+        Network &masked);
+
+index_t next_edge (const Network &network,
+        const index_t this_edge,
+        const bool left);
 
 void fillPathEdges (const Network &network,
-        PathData &pathData);
+        PathData &pathData,
+        const std::vector <index_t> &edges);
 
 }
 
 namespace cycles {
 
-std::string nextPathEdge (PathData &pathData);
-
-std::vector <size_t> get_nbs (const Network &network,
-        const size_t this_edge);
+index_t nextPathEdge (const Network &network, PathData &pathData);
 
 bool increment_cycle (const Network &network,
         PathData &pathData,
-        const std::string &start_edge,
+        const index_t start_edge,
         const bool left = true,
         const bool start = true);
 
+void new_trace (const Network &network, PathData &pathData);
+
 size_t path_loop_vert (const PathData &pathData);
 
-void trace_cycle (const Network &network,
+bool trace_cycle (const Network &network,
         PathData &pathData,
         const bool left = true);
 
-void cut_path (PathData &pathData);
+void cut_path (const Network &network, PathData &pathData);
 
-size_t path_hash (const PathData &pathData);
+void undir_edges (const Network &network,
+        const std::vector <index_t> &path,
+        std::vector <index_t> &edges);
 
-void trace_edge_set (PathData &pathData, PathEdgeSet &path_edges,
-        const Network &network, const bool left,
-        std::unordered_set <size_t> &path_hashes);
+void add_path_edge (const Network &network,
+        PathData &pathData,
+        const index_t edge);
+
+void remove_path_edge (const Network &network,
+        PathData &pathData,
+        const index_t edge);
+
+void trace_edge_set (PathData &pathData, CycleSet &cycle_set,
+        const Network &network, const bool left);
+
+void trace_parallel (const Network &network,
+        const std::vector <index_t> &edges,
+        CycleSet &cycle_set,
+        const bool left,
+        const int nthreads);
+
+void trace_network (const Network &network,
+        const std::vector <index_t> &start,
+        std::vector <std::vector <index_t> > &paths,
+        std::vector <CycleKey> &keys,
+        const bool left,
+        const int nthreads);
+
+CycleKey path_key (const Network &network,
+        const std::vector <index_t> &path);
+
+void merge_paths (const Network &network,
+        const std::vector <std::vector <std::vector <index_t> > > &path_sets,
+        std::vector <std::vector <index_t> > &paths,
+        std::vector <CycleKey> &keys);
+
+void trace_left_right (const Network &network,
+        const std::vector <index_t> &start,
+        std::vector <std::vector <index_t> > &paths_left,
+        std::vector <std::vector <index_t> > &paths_right,
+        std::vector <CycleKey> &keys_left,
+        std::vector <CycleKey> &keys_right,
+        const int nthreads);
 
 } // end namespace cycles
 
 namespace next_cycle {
 
-void single_edges (const PathEdgeSet &path_edges, PathData &pathData);
+void single_edges (const Network &network,
+        const std::vector <std::vector <index_t> > &paths,
+        std::vector <index_t> &edges);
 
 }
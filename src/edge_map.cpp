@@ -0,0 +1,26 @@
+#include "edge_map.h"
+
+// Build the map from the contracted edge index of each original edge, with
+// original edges indexed by position in 'edge_new'. This is a stable counting
+// sort, so original edges retain their input order within each contracted
+// edge.
+void edge_map::build (const std::vector <index_t> &edge_new,
+        const index_t n_new,
+        EdgeMap &emap)
+{
+    emap.offsets.assign (n_new + 1, 0L);
+    for (auto e: edge_new)
+        emap.offsets [e + 1]++;
+    for (index_t i = 0; i < n_new; i++)
+        emap.offsets [i + 1] += emap.offsets [i];
+
+    emap.edges_old.resize (edge_new.size ());
+    std::vector <index_t> pos (emap.offsets.begin (), emap.offsets.end () - 1);
+    for (index_t i = 0; i < edge_new.size (); i++)
+        emap.edges_old [pos [edge_new [i]]++] = i;
+}
+
+size_t edge_map::expanded_size (const EdgeMap &emap, const index_t e)
+{
+    return emap.offsets [e + 1] - emap.offsets [e];
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "typedefs.h"
+
+#include <vector>
+
+// Map from contracted edges to the original edges they contain, in compressed
+// sparse row form, so that contracted edge 'i' contains original edges
+// edges_old [offsets [i]:(offsets [i + 1] - 1)], in order. Reversed contracted
+// edges contain the same original edges in reverse order, and are not stored.
+struct EdgeMap
+{
+    std::vector <index_t> offsets;
+    std::vector <index_t> edges_old;
+};
+
+namespace edge_map {
+
+void build (const std::vector <index_t> &edge_new,
+        const index_t n_new,
+        EdgeMap &emap);
+
+size_t expanded_size (const EdgeMap &emap, const index_t e);
+
+} // end namespace edge_map
@@ -1,124 +1,170 @@
 #include "expand_edges.h"
-#include <unordered_map>
+#include "stats.h"
+
+#include <memory> // unique_ptr
 
 using namespace cpp11;
 namespace writable = cpp11::writable;
 
-// Copy a named column of a data.frame-like object into a std::vector.
-template <typename T1, typename T2>
-void edges_copy_column (
-        const list &df,
-        const std::string &col,
-        std::vector <T2> &result)
+// Find the contracted edge of ID 'e', which may also be a reversed edge with a
+// "_rev" suffix. Returns false if 'e' is not a contracted edge.
+bool expand_edges::find_edge (const EdgeMapHandle &handle,
+        const SEXP e,
+        index_t &index,
+        bool &rev)
 {
-    T1 s = df [col];
-    result.resize (static_cast <size_t> (s.size ()));
-    std::copy (s.begin (), s.end (), result.begin ());
-}
+    const CharView v {CHAR (e), static_cast <size_t> (LENGTH (e))};
+    auto it = handle.new_map.find (v);
+    rev = false;
+    if (it == handle.new_map.end ())
+    {
+        const CharView v_fwd = utils::cut_terminal_rev (v);
+        if (v_fwd.len == v.len)
+            return false;
+        it = handle.new_map.find (v_fwd);
+        if (it == handle.new_map.end ())
+            return false;
+        rev = true;
+    }
+    index = it->second;
 
-// Copy an indexed list item of type T1 into a std::vector.
-template <typename T1, typename T2>
-void edges_copy_list (
-        const T1 &li,
-        std::vector <T2> &result)
-{
-    result.resize (static_cast <size_t> (li.size ()));
-    std::copy (li.begin (), li.end (), result.begin ());
+    return true;
 }
 
-inline size_t expand_edges::count_edges (
-        const EdgeMapType &edge_map,
-        const std::vector <std::string> &edges) {
-
+size_t expand_edges::count_edges (const EdgeMapHandle &handle,
+        const SEXP edges)
+{
     size_t len = 0;
+    index_t index;
+    bool rev;
 
-    for (auto e: edges) {
-        if (edge_map.find (e) == edge_map.end ()) {
+    for (R_xlen_t i = 0; i < Rf_xlength (edges); i++)
+    {
+        if (expand_edges::find_edge (handle, STRING_ELT (edges, i), index, rev))
+            len += edge_map::expanded_size (handle.emap, index);
+        else
             len++;
-        } else {
-            len += edge_map.at (e).size ();
-        }
     }
 
     return len;
 }
 
-void expand_edges::fill_edges (
-        const EdgeMapType &edge_map,
-        const std::vector <std::string> &edges,
-        cpp11::writable::strings &edges_new) {
-
-    size_t i = 0;
-
-    for (auto e: edges) {
-        if (edge_map.find (e) == edge_map.end ()) {
-            edges_new [i++] = e;
-        } else {
-            const std::vector <std::string> edges_temp = edge_map.at (e);
-            for (auto et: edges_temp) {
-                edges_new [i++] = et;
-            }
+// Write expanded edges into 'edges_new' starting from 'pos', which is
+// incremented to the end of the expanded edges. Edges which are not contracted
+// are copied unchanged.
+void expand_edges::fill_edges (const EdgeMapHandle &handle,
+        const SEXP edges,
+        SEXP edges_new,
+        R_xlen_t &pos)
+{
+    const SEXP edge_old = handle.edge_old;
+    index_t index;
+    bool rev;
+
+    for (R_xlen_t i = 0; i < Rf_xlength (edges); i++)
+    {
+        const SEXP e = STRING_ELT (edges, i);
+        if (!expand_edges::find_edge (handle, e, index, rev))
+        {
+            SET_STRING_ELT (edges_new, pos++, e);
+            continue;
+        }
+
+        const index_t from = handle.emap.offsets [index],
+              to = handle.emap.offsets [index + 1];
+        for (index_t j = 0; j < to - from; j++)
+        {
+            const index_t k = rev ? to - 1 - j : from + j;
+            SET_STRING_ELT (edges_new, pos++, STRING_ELT (edge_old,
+                        static_cast <R_xlen_t> (handle.emap.edges_old [k])));
         }
     }
 }
 
-[[cpp11::register]]
-writable::list cpp_expand_edges(const list paths, const list edge_map_in,
-        const bool paths_are_list = false) {
+// Intern the IDs of contracted edges in 'handle.edge_new' to dense indices
+// in 'handle.new_map', returning the index of each entry of 'edge_new'.
+void expand_edges::fill_new_map (EdgeMapHandle &handle,
+        std::vector <index_t> &new_index)
+{
+    const SEXP edge_new = handle.edge_new;
+    const R_xlen_t n = Rf_xlength (edge_new);
+    new_index.resize (static_cast <size_t> (n));
+    handle.new_map.reserve (static_cast <size_t> (n));
+    for (R_xlen_t i = 0; i < n; i++)
+    {
+        const SEXP e = STRING_ELT (edge_new, i);
+        const CharView v {CHAR (e), static_cast <size_t> (LENGTH (e))};
+        auto it = handle.new_map.emplace (v,
+                static_cast <index_t> (handle.new_map.size ()));
+        new_index [static_cast <size_t> (i)] = it.first->second;
+    }
+}
 
-    std::vector <std::string> edge_old, edge_new;
+// Build a persistent edge map from the "edge_map" table of a contracted graph,
+// returned as an external pointer.
+[[cpp11::register]]
+SEXP cpp_edge_map(const list edge_map_in)
+{
+    stats::PhaseTimer timer ("edge_map");
 
-    edges_copy_column <strings, std::string> (edge_map_in, "edge_old", edge_old);
-    edges_copy_column <strings, std::string> (edge_map_in, "edge_new", edge_new);
+    std::unique_ptr <EdgeMapHandle> handle (new EdgeMapHandle);
+    handle->edge_new = strings (edge_map_in ["edge_new"]);
+    handle->edge_old = strings (edge_map_in ["edge_old"]);
 
-    EdgeMapType edge_map;
+    std::vector <index_t> new_index;
+    expand_edges::fill_new_map (*handle, new_index);
 
-    const size_t n = edge_old.size ();
-    for (size_t i = 0; i < n; i++) {
+    edge_map::build (new_index,
+            static_cast <index_t> (handle->new_map.size ()), handle->emap);
 
-        std::vector <std::string> edge_set;
-        if (edge_map.find (edge_new [i]) != edge_map.end ()) {
-            edge_set = edge_map.at (edge_new [i]);
-            edge_map.erase (edge_new [i]);
-        }
-        edge_set.push_back (edge_old [i]);
+    external_pointer <EdgeMapHandle> ptr (handle.release ());
 
-        edge_map.emplace (edge_new [i], edge_set);
-    }
+    return ptr;
+}
 
-    cpp11::writable::list out (static_cast <R_xlen_t> (paths.size ()));
+// Expand all contracted edges of 'paths', which are either lists of edge IDs,
+// or data.frames with "edge_" columns. Expanded edges of all paths are written
+// into a single vector, returned in a list with a second vector of offsets,
+// so that expanded edges of path 'i' are in (offsets [i] + 1):offsets [i + 1].
+[[cpp11::register]]
+writable::list cpp_expand_edges(SEXP edge_map, const list paths,
+        const bool paths_are_list)
+{
+    stats::PhaseTimer timer ("expand_edges");
 
-    R_xlen_t i = 0;
+    external_pointer <EdgeMapHandle> ptr (edge_map);
+    if (ptr.get () == nullptr)
+        cpp11::stop ("Edge map is no longer valid");
+    const EdgeMapHandle &handle = *ptr;
 
-    if (paths_are_list)
+    const R_xlen_t n = paths.size ();
+    std::vector <SEXP> path_edges (static_cast <size_t> (n));
+    writable::integers offsets (n + 1);
+    offsets [0] = 0L;
+    size_t len = 0;
+    for (R_xlen_t i = 0; i < n; i++)
     {
-        for (R_xlen_t i = 0; i < paths.size (); i++)
+        if (paths_are_list)
         {
-            std::vector <std::string> edges_i;
-            edges_copy_list <strings, std::string> (paths [i], edges_i);
-
-            size_t len = expand_edges::count_edges (edge_map, edges_i);
-
-            cpp11::writable::strings edges_new (static_cast <R_xlen_t> (len));
-            expand_edges::fill_edges (edge_map, edges_i, edges_new);
-
-            out [i] = edges_new;
-        }
-    } else
-    {
-        for (const list pi: paths)
+            path_edges [static_cast <size_t> (i)] = paths [i];
+        } else
         {
-            std::vector <std::string> edges_i;
-            edges_copy_column <strings, std::string> (pi, "edge_", edges_i);
-
-            size_t len = expand_edges::count_edges (edge_map, edges_i);
-
-            cpp11::writable::strings edges_new (static_cast <R_xlen_t> (len));
-            expand_edges::fill_edges (edge_map, edges_i, edges_new);
-
-            out [i++] = edges_new;
+            const list pi = paths [i];
+            path_edges [static_cast <size_t> (i)] = pi ["edge_"];
         }
+        len += expand_edges::count_edges (handle,
+                path_edges [static_cast <size_t> (i)]);
+        offsets [i + 1] = static_cast <int> (len);
     }
 
+    writable::strings edges_new (static_cast <R_xlen_t> (len));
+    R_xlen_t pos = 0;
+    for (auto e: path_edges)
+        expand_edges::fill_edges (handle, e, edges_new, pos);
+
+    writable::list out (2);
+    out [0] = edges_new;
+    out [1] = offsets;
+
     return out;
 }
@@ -1,32 +1,40 @@
 #pragma once
 
 #include "typedefs.h"
+#include "utils.h"
+#include "edge_map.h"
 
 #include "cpp11.hpp"
 
-#include <limits>
-#include <numeric> // std::iota
-#include <iostream> // TODO: Remove that
-#include <ctime>
-#include <stdexcept>
-#include <string>
 #include <vector>
 #include <unordered_map>
-#include <set>
 
-typedef std::unordered_map <std::string, std::vector <std::string> > EdgeMapType;
-
-using namespace cpp11;
+// Persistent map from contracted to original edges. The R vectors of edge IDs
+// from which the map was built are retained, so that contracted edges can be
+// looked up by views of their IDs, and expanded edges returned as the
+// original CHARSXP values without copying.
+struct EdgeMapHandle
+{
+    cpp11::strings edge_new;
+    cpp11::strings edge_old;
+    std::unordered_map <CharView, index_t, CharViewHash> new_map;
+    EdgeMap emap;
+};
 
 namespace expand_edges {
 
-inline size_t count_edges (
-        const EdgeMapType &edge_map,
-        const std::vector <std::string> &edges);
+void fill_new_map (EdgeMapHandle &handle, std::vector <index_t> &new_index);
+
+bool find_edge (const EdgeMapHandle &handle,
+        const SEXP e,
+        index_t &index,
+        bool &rev);
+
+size_t count_edges (const EdgeMapHandle &handle, const SEXP edges);
 
-void fill_edges (
-        const EdgeMapType &edge_map,
-        const std::vector <std::string> &edges,
-        cpp11::writable::strings &edges_new);
+void fill_edges (const EdgeMapHandle &handle,
+        const SEXP edges,
+        SEXP edges_new,
+        R_xlen_t &pos);
 
 } // end namespace expand_edges
@@ -0,0 +1,179 @@
+#include "typedefs.h"
+#include "ingest.h"
+#include "cycles.h"
+#include "face_update.h"
+#include "stats.h"
+
+#include "cpp11.hpp"
+
+#include <memory> // unique_ptr
+#include <numeric> // iota
+
+using namespace cpp11;
+
+// Get the face graph held by an external pointer returned from
+// 'cpp_face_graph'.
+FaceGraph &face_update_get_graph (SEXP graph)
+{
+    external_pointer <FaceGraph> ptr (graph);
+    if (ptr.get () == nullptr)
+        cpp11::stop ("Face set is no longer valid; it must be rebuilt");
+    return *ptr;
+}
+
+// Edges of faces as lists of 1-based indices into graph edges, with a
+// logical vector flagging unbounded faces.
+writable::list face_update_faces (const FaceGraph &graph,
+        const std::vector <index_t> &faces)
+{
+    const R_xlen_t n = static_cast <R_xlen_t> (faces.size ());
+    writable::list faces_out (n);
+    writable::logicals outer (n);
+    for (R_xlen_t i = 0; i < n; i++)
+    {
+        const index_t f = faces [static_cast <size_t> (i)];
+        const std::vector <index_t> &fe = graph.face_edges [f];
+        writable::integers edge_index (static_cast <R_xlen_t> (fe.size ()));
+        for (size_t j = 0; j < fe.size (); j++)
+            edge_index [static_cast <R_xlen_t> (j)] = static_cast <int> (fe [j]) + 1L;
+        faces_out [i] = edge_index;
+        outer [i] = graph.face_area [f] <= 0.0;
+    }
+
+    writable::list res (2);
+    res [0] = faces_out;
+    res [1] = outer;
+
+    return res;
+}
+
+// Convert IDs to 1-based R indices.
+writable::integers face_update_ids (const std::vector <index_t> &ids)
+{
+    writable::integers out (static_cast <R_xlen_t> (ids.size ()));
+    for (size_t i = 0; i < ids.size (); i++)
+        out [static_cast <R_xlen_t> (i)] = static_cast <int> (ids [i]) + 1L;
+    return out;
+}
+
+// Adjacency rows as list of 1-based (from, to) face IDs, and lists of 1-based
+// indices of shared edges.
+writable::list face_update_adjacency (const AdjacencyData &adj)
+{
+    const R_xlen_t npairs = static_cast <R_xlen_t> (adj.from.size ());
+    writable::list edges (npairs);
+    for (R_xlen_t i = 0; i < npairs; i++)
+    {
+        const index_t e0 = adj.offsets [static_cast <size_t> (i)],
+              e1 = adj.offsets [static_cast <size_t> (i) + 1];
+        writable::integers edges_i (static_cast <R_xlen_t> (e1 - e0));
+        for (index_t j = e0; j < e1; j++)
+            edges_i [static_cast <R_xlen_t> (j - e0)] =
+                static_cast <int> (adj.edges [j]) + 1L;
+        edges [i] = edges_i;
+    }
+
+    writable::list res (3);
+    res [0] = face_update_ids (adj.from);
+    res [1] = face_update_ids (adj.to);
+    res [2] = edges;
+
+    return res;
+}
+
+// Build an updatable face graph from the data.frame passed from R, in which
+// every edge must have a reverse. Return value is a list of the graph as an
+// external pointer; the vertex IDs in the order in which vertices are
+// indexed; and the faces of the graph as for 'face_update_faces'.
+[[cpp11::register]]
+writable::list cpp_face_graph(list df)
+{
+    stats::PhaseTimer timer ("face_graph");
+
+    NetworkColumns cols;
+    ingest::network_columns (df, cols);
+    Network network;
+    build_network::fill_network (network, cols);
+
+    std::unique_ptr <FaceGraph> graph (new FaceGraph);
+    if (!face_update::build (network, *graph))
+        cpp11::stop ("Face sets can only be built for networks in which "
+                "every edge has a reverse");
+
+    writable::strings verts (static_cast <R_xlen_t> (cols.n_verts));
+    for (size_t i = 0; i < cols.n_verts; i++)
+        SET_STRING_ELT (verts, static_cast <R_xlen_t> (i),
+                Rf_mkCharLenCE (cols.vert_ids [i].s,
+                    static_cast <int> (cols.vert_ids [i].len), CE_UTF8));
+
+    std::vector <index_t> all_faces (graph->face_edges.size ());
+    std::iota (all_faces.begin (), all_faces.end (), 0);
+    const writable::list faces = face_update_faces (*graph, all_faces);
+
+    external_pointer <FaceGraph> ptr (graph.release ());
+
+    writable::list res (3);
+    res [0] = ptr;
+    res [1] = verts;
+    res [2] = faces;
+
+    return res;
+}
+
+// Delete edges with the 1-based indices 'deletions' along with their
+// reverses, and insert edges between 1-based vertex indices 'v0' and 'v1'
+// along with their reverses, where vertices beyond those of the graph are new.
+// Inserted edges are appended to the graph edges in pairs of each edge
+// followed by its reverse. 'version' must be the number of updates previously
+// applied to the graph. Return value is a list of the 1-based IDs of removed
+// faces; the added faces, as for 'face_update_faces', with IDs following all
+// previous faces; the removed and added rows of the adjacency of faces, as for
+// 'face_update_adjacency'; and the new version.
+[[cpp11::register]]
+writable::list cpp_face_update(SEXP graph, const int version,
+        integers deletions, integers v0, integers v1,
+        doubles x0, doubles y0, doubles x1, doubles y1)
+{
+    stats::PhaseTimer timer ("face_update");
+
+    FaceGraph &g = face_update_get_graph (graph);
+    if (g.version != version)
+        cpp11::stop ("Face set has since been updated; only the most recent "
+                "result of 'face_set_update' can be updated");
+
+    std::vector <index_t> del (static_cast <size_t> (deletions.size ()));
+    for (R_xlen_t i = 0; i < deletions.size (); i++)
+    {
+        const int e = deletions [i];
+        if (e < 1 || static_cast <size_t> (e) > g.edges.size ())
+            cpp11::stop ("Edge indices must be within the face set");
+        del [static_cast <size_t> (i)] = static_cast <index_t> (e - 1);
+    }
+
+    const size_t n_ins = static_cast <size_t> (v0.size ());
+    std::vector <FaceInsert> ins (n_ins);
+    for (size_t i = 0; i < n_ins; i++)
+    {
+        const R_xlen_t ir = static_cast <R_xlen_t> (i);
+        if (v0 [ir] < 1 || v1 [ir] < 1 || v0 [ir] == v1 [ir])
+            cpp11::stop ("Inserted edges must join two distinct vertices");
+        ins [i] = FaceInsert {static_cast <index_t> (v0 [ir] - 1),
+            static_cast <index_t> (v1 [ir] - 1), x0 [ir], y0 [ir], x1 [ir],
+            y1 [ir]};
+    }
+
+    FaceDiff diff;
+    face_update::update (g, del, ins, diff);
+
+    writable::integers version_out (1);
+    version_out [0] = g.version;
+
+    writable::list res (5);
+    res [0] = face_update_ids (diff.removed);
+    res [1] = face_update_faces (g, diff.added);
+    res [2] = face_update_adjacency (diff.adj_removed);
+    res [3] = face_update_adjacency (diff.adj_added);
+    res [4] = version_out;
+
+    return res;
+}
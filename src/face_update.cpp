@@ -0,0 +1,364 @@
+#include "face_update.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+// Build the half-edge form of a network and enumerate all of its faces, with
+// face IDs in the order of 'faces::enumerate'. Returns false if any edge has
+// no reverse.
+bool face_update::build (const Network &network, FaceGraph &graph)
+{
+    const size_t n = network.edges.size ();
+    for (size_t i = 0; i < n; i++)
+    {
+        if (network.edge_twin [i] == INFINITE_INDEX)
+            return false;
+    }
+
+    graph.edges = network.edges;
+    graph.twin = network.edge_twin;
+    graph.active.assign (n, true);
+
+    graph.rot_next.resize (n);
+    graph.rot_prev.resize (n);
+    graph.vert_first.assign (network.n_verts, INFINITE_INDEX);
+    for (size_t v = 0; v < network.n_verts; v++)
+    {
+        const index_t from = network.out_offset [v],
+              to = network.out_offset [v + 1];
+        if (from == to)
+            continue;
+
+        graph.vert_first [v] = network.out_edges [from];
+        for (index_t i = from; i < to; i++)
+        {
+            const index_t e = network.out_edges [i];
+            graph.rot_next [e] = network.out_edges [i + 1 == to ? from : i + 1];
+            graph.rot_prev [e] = network.out_edges [i == from ? to - 1 : i - 1];
+        }
+    }
+
+    FaceData faces;
+    faces::enumerate (network, faces);
+
+    const size_t nfaces = faces.area.size ();
+    graph.face_of.assign (n, INFINITE_INDEX);
+    graph.face_edges.resize (nfaces);
+    graph.face_area = faces.area;
+    for (size_t f = 0; f < nfaces; f++)
+    {
+        graph.face_edges [f].assign (faces.edges.begin () + faces.offsets [f],
+                faces.edges.begin () + faces.offsets [f + 1]);
+        for (auto e: graph.face_edges [f])
+            graph.face_of [e] = static_cast <index_t> (f);
+    }
+
+    graph.version = 0;
+
+    return true;
+}
+
+// Equivalent of 'faces::next_face_edge': the outgoing edge preceding the
+// reverse of 'e' in the rotation of its end vertex.
+index_t face_update::next_face_edge (const FaceGraph &graph, const index_t e)
+{
+    return graph.rot_prev [graph.twin [e]];
+}
+
+// Insert edge 'e' into the rotation of its start vertex, in the same position
+// as it would have were the rotation rebuilt with 'fill_rotation'.
+void face_update::ring_insert (FaceGraph &graph, const index_t e)
+{
+    const index_t v = graph.edges [e].v0;
+    const index_t first = graph.vert_first [v];
+    if (first == INFINITE_INDEX)
+    {
+        graph.rot_next [e] = graph.rot_prev [e] = e;
+        graph.vert_first [v] = e;
+        return;
+    }
+
+    // Edge 'e' is inserted before 'o', the first edge which follows it:
+    index_t o = first;
+    do {
+        if (build_network::rotation_less (graph.edges, e, o))
+            break;
+        o = graph.rot_next [o];
+    } while (o != first);
+
+    const index_t p = graph.rot_prev [o];
+    graph.rot_next [p] = e;
+    graph.rot_prev [e] = p;
+    graph.rot_next [e] = o;
+    graph.rot_prev [o] = e;
+
+    if (build_network::rotation_less (graph.edges, e, first))
+        graph.vert_first [v] = e;
+}
+
+void face_update::ring_remove (FaceGraph &graph, const index_t e)
+{
+    const index_t v = graph.edges [e].v0;
+    if (graph.rot_next [e] == e)
+    {
+        graph.vert_first [v] = INFINITE_INDEX;
+    } else
+    {
+        const index_t p = graph.rot_prev [e], nx = graph.rot_next [e];
+        graph.rot_next [p] = nx;
+        graph.rot_prev [nx] = p;
+        if (graph.vert_first [v] == e)
+            graph.vert_first [v] = nx;
+    }
+    graph.rot_next [e] = graph.rot_prev [e] = INFINITE_INDEX;
+}
+
+// Trace the face containing 'start', with edges rotated to start from the
+// lowest edge index, as for 'faces::enumerate'. Every active edge has an
+// active reverse, so the traversal always returns to 'start'. Return value is
+// the signed area of the face.
+double face_update::trace_face (const FaceGraph &graph,
+        const index_t start,
+        std::vector <index_t> &face)
+{
+    face.clear ();
+    double a = 0.0;
+    index_t e = start;
+    do {
+        face.push_back (e);
+        const OneEdge &ei = graph.edges [e];
+        a += ei.x0 * ei.y1 - ei.x1 * ei.y0;
+        e = face_update::next_face_edge (graph, e);
+    } while (e != start);
+
+    std::rotate (face.begin (), std::min_element (face.begin (), face.end ()),
+            face.end ());
+
+    return a / 2.0;
+}
+
+// Rows of the adjacency of each of 'faces' with all faces on the other sides
+// of its edges, along with the reversed rows for neighbouring faces which are
+// not themselves flagged in 'in_set', so that each row is added only once.
+void face_update::adjacency_rows (const FaceGraph &graph,
+        const std::vector <index_t> &faces,
+        const std::vector <bool> &in_set,
+        FaceAdjRows &rows)
+{
+    for (auto f: faces)
+    {
+        for (auto e: graph.face_edges [f])
+        {
+            const index_t g = graph.face_of [graph.twin [e]];
+            if (g == f)
+                continue;
+            rows.emplace_back (f, g, e);
+            if (!in_set [g])
+                rows.emplace_back (g, f, graph.twin [e]);
+        }
+    }
+}
+
+// Group rows into pairs of faces, each with all shared edges.
+void face_update::group_rows (FaceAdjRows &rows, AdjacencyData &adj)
+{
+    std::sort (rows.begin (), rows.end ());
+
+    adj.from.clear ();
+    adj.to.clear ();
+    adj.edges.clear ();
+    adj.offsets.assign (1, 0L);
+
+    for (size_t i = 0; i < rows.size (); i++)
+    {
+        const index_t f = std::get <0> (rows [i]), g = std::get <1> (rows [i]);
+        if (i == 0 || f != std::get <0> (rows [i - 1]) ||
+                g != std::get <1> (rows [i - 1]))
+        {
+            if (i > 0)
+                adj.offsets.push_back (static_cast <index_t> (adj.edges.size ()));
+            adj.from.push_back (f);
+            adj.to.push_back (g);
+        }
+        adj.edges.push_back (std::get <2> (rows [i]));
+    }
+    if (!rows.empty ())
+        adj.offsets.push_back (static_cast <index_t> (adj.edges.size ()));
+}
+
+// Delete edges along with their reverses, and insert new edges along with
+// their reverses, re-tracing only those faces which contain deleted edges or
+// edges ending at any vertex of an edited edge, as those are the only edges
+// whose next face edges change. Deleted edges which are already inactive are
+// ignored.
+void face_update::update (FaceGraph &graph,
+        const std::vector <index_t> &deletions,
+        const std::vector <FaceInsert> &insertions,
+        FaceDiff &diff)
+{
+    diff = FaceDiff ();
+
+    std::vector <index_t> verts;
+    for (auto e: deletions)
+    {
+        if (!graph.active [e])
+            continue;
+        verts.push_back (graph.edges [e].v0);
+        verts.push_back (graph.edges [e].v1);
+    }
+    for (const auto &ins: insertions)
+    {
+        verts.push_back (ins.v0);
+        verts.push_back (ins.v1);
+    }
+    std::sort (verts.begin (), verts.end ());
+    verts.erase (std::unique (verts.begin (), verts.end ()), verts.end ());
+
+    const size_t nfaces0 = graph.face_edges.size ();
+    std::vector <bool> removed (nfaces0, false);
+    const auto remove_face = [&graph, &removed, &diff] (const index_t e) {
+        const index_t f = graph.face_of [e];
+        if (f != INFINITE_INDEX && !removed [f])
+        {
+            removed [f] = true;
+            diff.removed.push_back (f);
+        }
+    };
+
+    for (auto e: deletions)
+    {
+        if (!graph.active [e])
+            continue;
+        remove_face (e);
+        remove_face (graph.twin [e]);
+    }
+    for (auto v: verts)
+    {
+        if (v >= graph.vert_first.size () ||
+                graph.vert_first [v] == INFINITE_INDEX)
+            continue;
+        const index_t first = graph.vert_first [v];
+        index_t o = first;
+        do {
+            remove_face (graph.twin [o]);
+            o = graph.rot_next [o];
+        } while (o != first);
+    }
+    std::sort (diff.removed.begin (), diff.removed.end ());
+
+    FaceAdjRows rows_removed;
+    face_update::adjacency_rows (graph, diff.removed, removed, rows_removed);
+
+    // Faces are re-traced from all remaining edges of removed faces, which are
+    // indexed by their first edges so that unchanged faces can be recognised:
+    std::vector <index_t> seeds;
+    std::unordered_map <index_t, index_t> removed_by_first;
+    for (auto f: diff.removed)
+    {
+        removed_by_first.emplace (graph.face_edges [f].front (), f);
+        for (auto e: graph.face_edges [f])
+        {
+            graph.face_of [e] = INFINITE_INDEX;
+            seeds.push_back (e);
+        }
+    }
+
+    for (auto e: deletions)
+    {
+        if (!graph.active [e])
+            continue;
+        for (auto d: {e, graph.twin [e]})
+        {
+            face_update::ring_remove (graph, d);
+            graph.active [d] = false;
+        }
+    }
+
+    for (const auto &ins: insertions)
+    {
+        const index_t e = static_cast <index_t> (graph.edges.size ());
+        graph.edges.push_back (OneEdge {ins.x0, ins.y0, ins.x1, ins.y1,
+                ins.v0, ins.v1, e});
+        graph.edges.push_back (OneEdge {ins.x1, ins.y1, ins.x0, ins.y0,
+                ins.v1, ins.v0, e + 1});
+        graph.twin.push_back (e + 1);
+        graph.twin.push_back (e);
+        graph.active.resize (e + 2, true);
+        graph.rot_next.resize (e + 2, INFINITE_INDEX);
+        graph.rot_prev.resize (e + 2, INFINITE_INDEX);
+        graph.face_of.resize (e + 2, INFINITE_INDEX);
+
+        const size_t nv = static_cast <size_t> (std::max (ins.v0, ins.v1)) + 1;
+        if (graph.vert_first.size () < nv)
+            graph.vert_first.resize (nv, INFINITE_INDEX);
+
+        face_update::ring_insert (graph, e);
+        face_update::ring_insert (graph, e + 1);
+        seeds.push_back (e);
+        seeds.push_back (e + 1);
+    }
+
+    std::sort (seeds.begin (), seeds.end ());
+
+    std::vector <bool> kept (nfaces0, false);
+    std::vector <index_t> face;
+    for (auto s: seeds)
+    {
+        if (!graph.active [s] || graph.face_of [s] != INFINITE_INDEX)
+            continue;
+
+        const double area = face_update::trace_face (graph, s, face);
+
+        index_t id = INFINITE_INDEX;
+        const auto it = removed_by_first.find (face.front ());
+        if (it != removed_by_first.end () &&
+                graph.face_edges [it->second] == face)
+        {
+            id = it->second;
+            kept [id] = true;
+        } else
+        {
+            id = static_cast <index_t> (graph.face_edges.size ());
+            graph.face_edges.push_back (face);
+            graph.face_area.push_back (area);
+            diff.added.push_back (id);
+        }
+        for (auto e: face)
+            graph.face_of [e] = id;
+    }
+
+    // Faces traced again unchanged are neither removed nor added, and nor are
+    // any adjacency rows between them and other unchanged faces:
+    std::vector <index_t> removed_final;
+    for (auto f: diff.removed)
+    {
+        if (kept [f])
+        {
+            removed [f] = false;
+        } else
+        {
+            graph.face_edges [f].clear ();
+            graph.face_edges [f].shrink_to_fit ();
+            graph.face_area [f] = 0.0;
+            removed_final.push_back (f);
+        }
+    }
+    diff.removed.swap (removed_final);
+
+    rows_removed.erase (std::remove_if (rows_removed.begin (),
+                rows_removed.end (),
+                [&removed] (const std::tuple <index_t, index_t, index_t> &r) {
+                    return !removed [std::get <0> (r)] &&
+                        !removed [std::get <1> (r)]; }),
+            rows_removed.end ());
+    face_update::group_rows (rows_removed, diff.adj_removed);
+
+    std::vector <bool> added (graph.face_edges.size (), false);
+    for (auto f: diff.added)
+        added [f] = true;
+    FaceAdjRows rows_added;
+    face_update::adjacency_rows (graph, diff.added, added, rows_added);
+    face_update::group_rows (rows_added, diff.adj_added);
+
+    graph.version++;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "typedefs.h"
+#include "cycles.h"
+#include "faces.h"
+#include "adjacency.h"
+
+#include <tuple>
+#include <vector>
+
+// Mutable half-edge form of a network and all of its faces, which can be
+// updated after local edits by re-tracing only the faces around edited edges.
+// Every edge must have a reverse. Edges are never re-indexed: inserted edges
+// are appended, and deleted edges remain as inactive entries. Face IDs are
+// likewise never reused, and removed faces have no edges.
+struct FaceGraph
+{
+    EdgeVec edges;
+    std::vector <index_t> twin;
+    std::vector <bool> active;
+    // Rotation system as circular lists of the active outgoing edges of each
+    // vertex, anticlockwise by angle, with 'vert_first' the first of these in
+    // the order of 'build_network::rotation_less', or INFINITE_INDEX for
+    // vertices with no active edges:
+    std::vector <index_t> rot_next;
+    std::vector <index_t> rot_prev;
+    std::vector <index_t> vert_first;
+    // Face of each active edge, and edges of each face starting from the
+    // lowest edge index:
+    std::vector <index_t> face_of;
+    std::vector <std::vector <index_t> > face_edges;
+    std::vector <double> face_area;
+    // Number of updates applied:
+    int version = 0;
+};
+
+// An edge to be inserted along with its reverse, between vertices which may
+// extend beyond those of the graph.
+struct FaceInsert
+{
+    index_t v0, v1;
+    double x0, y0, x1, y1;
+};
+
+// Faces removed and added by an update, and the rows of the adjacency of
+// faces which are removed and added, with shared edges of each pair of faces
+// as indices of edges of the 'from' faces. Faces which are removed and then
+// traced again unchanged retain their IDs, and are in neither list.
+struct FaceDiff
+{
+    std::vector <index_t> removed;
+    std::vector <index_t> added;
+    AdjacencyData adj_removed;
+    AdjacencyData adj_added;
+};
+
+// Rows of (from, to, edge) of the adjacency of faces:
+typedef std::vector <std::tuple <index_t, index_t, index_t> > FaceAdjRows;
+
+namespace face_update {
+
+bool build (const Network &network, FaceGraph &graph);
+
+index_t next_face_edge (const FaceGraph &graph, const index_t e);
+
+void ring_insert (FaceGraph &graph, const index_t e);
+
+void ring_remove (FaceGraph &graph, const index_t e);
+
+double trace_face (const FaceGraph &graph,
+        const index_t start,
+        std::vector <index_t> &face);
+
+void adjacency_rows (const FaceGraph &graph,
+        const std::vector <index_t> &faces,
+        const std::vector <bool> &in_set,
+        FaceAdjRows &rows);
+
+void group_rows (FaceAdjRows &rows, AdjacencyData &adj);
+
+void update (FaceGraph &graph,
+        const std::vector <index_t> &deletions,
+        const std::vector <FaceInsert> &insertions,
+        FaceDiff &diff);
+
+} // end namespace face_update
@@ -0,0 +1,412 @@
+#include "faces.h"
+#include "stats.h"
+
+#include <cmath>
+
+// Position of each edge in the rotation of outgoing edges from its start
+// vertex.
+void faces::fill_rotation_pos (const Network &network,
+        std::vector <index_t> &rot_pos)
+{
+    rot_pos.resize (network.edges.size ());
+    for (size_t v = 0; v < network.n_verts; v++)
+    {
+        for (index_t i = network.out_offset [v];
+                i < network.out_offset [v + 1]; i++)
+            rot_pos [network.out_edges [i]] = i - network.out_offset [v];
+    }
+}
+
+// The next edge around a face is the first outgoing edge encountered when
+// rotating clockwise from the reverse of 'this_edge'. This is the standard
+// half-edge (DCEL) face traversal, which traces bounded faces anticlockwise.
+// Unlike 'build_network::next_edge', edges returning to the start vertex are
+// allowed, so every directed edge is in exactly one face. Edges with no
+// reverse fall back to the equivalent left turn.
+index_t faces::next_face_edge (const Network &network,
+        const std::vector <index_t> &rot_pos,
+        const index_t this_edge)
+{
+    const index_t twin = network.edge_twin [this_edge];
+    if (twin == INFINITE_INDEX)
+        return network.next_left [this_edge];
+
+    const index_t v = network.edges [this_edge].v1;
+    const index_t nout = network.out_offset [v + 1] - network.out_offset [v];
+    const index_t i = (rot_pos [twin] + nout - 1) % nout;
+
+    return network.out_edges [network.out_offset [v] + i];
+}
+
+// Shoelace formula for signed area of face formed by edges [from:(to - 1)].
+double faces::face_area (const Network &network,
+        const std::vector <index_t> &edges,
+        const size_t from,
+        const size_t to)
+{
+    double a = 0.0;
+    for (size_t i = from; i < to; i++)
+    {
+        const OneEdge &e = network.edges [edges [i]];
+        a += e.x0 * e.y1 - e.x1 * e.y0;
+    }
+    return a / 2.0;
+}
+
+// Enumerate all faces in a single pass which visits each directed edge once.
+// Faces are discarded if the traversal fails to return to its starting edge,
+// which can only happen where edges have no reverse.
+void faces::enumerate (const Network &network, FaceData &faces)
+{
+    const size_t n = network.edges.size ();
+
+    std::vector <index_t> rot_pos;
+    faces::fill_rotation_pos (network, rot_pos);
+
+    faces.edges.clear ();
+    faces.edges.reserve (n);
+    faces.offsets.assign (1, 0L);
+    faces.area.clear ();
+
+    std::vector <bool> visited (n, false);
+
+    for (index_t i = 0; i < n; i++)
+    {
+        if (visited [i])
+            continue;
+
+        const size_t start = faces.edges.size ();
+        index_t e = i;
+        while (e != INFINITE_INDEX && !visited [e])
+        {
+            visited [e] = true;
+            faces.edges.push_back (e);
+            e = faces::next_face_edge (network, rot_pos, e);
+        }
+
+        if (e != i)
+        {
+            faces.edges.resize (start);
+            continue;
+        }
+
+        faces.offsets.push_back (static_cast <index_t> (faces.edges.size ()));
+        faces.area.push_back (faces::face_area (network, faces.edges,
+                    start, faces.edges.size ()));
+    }
+}
+
+// Index of the tile containing the point (x, y). Points outside the tiled
+// area are in the nearest tile, and non-finite points are in the first tile.
+size_t faces::tile_of (const FaceTiles &tiles, const double x, const double y)
+{
+    if (!std::isfinite (x) || !std::isfinite (y))
+        return 0;
+
+    const double fx = std::floor ((x - tiles.xmin) / tiles.dx);
+    const double fy = std::floor ((y - tiles.ymin) / tiles.dy);
+    const size_t ix = fx <= 0.0 ? 0 : std::min (tiles.nx - 1,
+            static_cast <size_t> (fx));
+    const size_t iy = fy <= 0.0 ? 0 : std::min (tiles.ny - 1,
+            static_cast <size_t> (fy));
+
+    return iy * tiles.nx + ix;
+}
+
+// Whether the start vertex of an edge is in the core or halo of a tile.
+bool faces::in_region (const FaceTiles &tiles, const size_t tile,
+        const OneEdge &e)
+{
+    if (faces::tile_of (tiles, e.x0, e.y0) == tile)
+        return true;
+
+    const double ix = static_cast <double> (tile % tiles.nx);
+    const double iy = static_cast <double> (tile / tiles.nx);
+    const double x0 = tiles.xmin + ix * tiles.dx;
+    const double y0 = tiles.ymin + iy * tiles.dy;
+
+    return e.x0 >= x0 - tiles.halo_x && e.x0 <= x0 + tiles.dx + tiles.halo_x &&
+        e.y0 >= y0 - tiles.halo_y && e.y0 <= y0 + tiles.dy + tiles.halo_y;
+}
+
+// Divide the bounding box of all edges into 'ntiles' x 'ntiles' tiles, and
+// bucket edges by the tiles containing their start vertices.
+void faces::build_tiles (const Network &network,
+        const size_t ntiles,
+        FaceTiles &tiles)
+{
+    double xmin = INFINITY, xmax = -INFINITY, ymin = INFINITY, ymax = -INFINITY;
+    for (const auto &e: network.edges)
+    {
+        if (!std::isfinite (e.x0) || !std::isfinite (e.y0))
+            continue;
+        xmin = std::min (xmin, e.x0);
+        xmax = std::max (xmax, e.x0);
+        ymin = std::min (ymin, e.y0);
+        ymax = std::max (ymax, e.y0);
+    }
+    if (xmin > xmax)
+        xmin = xmax = ymin = ymax = 0.0;
+
+    tiles.nx = tiles.ny = std::max (static_cast <size_t> (1), ntiles);
+    tiles.xmin = xmin;
+    tiles.ymin = ymin;
+    tiles.dx = (xmax - xmin) / static_cast <double> (tiles.nx);
+    tiles.dy = (ymax - ymin) / static_cast <double> (tiles.ny);
+    if (!(tiles.dx > 0.0))
+        tiles.dx = 1.0;
+    if (!(tiles.dy > 0.0))
+        tiles.dy = 1.0;
+    tiles.halo_x = FACE_TILE_HALO * tiles.dx;
+    tiles.halo_y = FACE_TILE_HALO * tiles.dy;
+
+    const size_t n_tiles = tiles.nx * tiles.ny;
+    const size_t n = network.edges.size ();
+    std::vector <size_t> tile (n);
+    tiles.offsets.assign (n_tiles + 1, 0L);
+    for (size_t i = 0; i < n; i++)
+    {
+        tile [i] = faces::tile_of (tiles, network.edges [i].x0,
+                network.edges [i].y0);
+        tiles.offsets [tile [i] + 1]++;
+    }
+    for (size_t t = 0; t < n_tiles; t++)
+        tiles.offsets [t + 1] += tiles.offsets [t];
+
+    tiles.edges.resize (n);
+    std::vector <index_t> fill (tiles.offsets.begin (), tiles.offsets.end () - 1);
+    for (size_t i = 0; i < n; i++)
+        tiles.edges [fill [tile [i]]++] = static_cast <index_t> (i);
+}
+
+// Follow face edges from 'start' until the path returns to an edge of the
+// current trace, so closing a cycle. Traces also stop at dead ends, and at
+// edges visited in earlier traces with IDs of at least 'first_id', from which
+// any cycles have already been traced. Where 'tiles' is not null, traces which
+// leave the region of 'tile' are abandoned as escaped. Cycles are returned in
+// 'cycle', rotated to start at their lowest edge index.
+FaceTrace faces::trace_from (const Network &network,
+        const std::vector <index_t> &rot_pos,
+        const FaceTiles *tiles,
+        const size_t tile,
+        const index_t start,
+        const index_t first_id,
+        FaceWork &work,
+        std::vector <index_t> &cycle)
+{
+    work.trace_id++;
+    work.path.clear ();
+
+    index_t e = start;
+    while (e != INFINITE_INDEX)
+    {
+        if (work.mark [e] >= first_id)
+        {
+            if (work.mark [e] != work.trace_id)
+                return FaceTrace::STOPPED;
+
+            cycle.assign (work.path.begin () + work.pos [e], work.path.end ());
+            std::rotate (cycle.begin (),
+                    std::min_element (cycle.begin (), cycle.end ()),
+                    cycle.end ());
+            return FaceTrace::CYCLE;
+        }
+        if (tiles != nullptr &&
+                !faces::in_region (*tiles, tile, network.edges [e]))
+            return FaceTrace::ESCAPED;
+
+        work.mark [e] = work.trace_id;
+        work.pos [e] = static_cast <index_t> (work.path.size ());
+        work.path.push_back (e);
+        e = faces::next_face_edge (network, rot_pos, e);
+    }
+
+    return FaceTrace::STOPPED;
+}
+
+// Trace all cycles from the core edges of one tile. Cycles are retained only
+// where their lowest edge is in the core of this tile, so each cycle is
+// retained by one tile only. The start edges of traces which escaped from the
+// region of the tile are returned as 'leftovers'.
+void faces::trace_tile (const Network &network,
+        const std::vector <index_t> &rot_pos,
+        const FaceTiles &tiles,
+        const size_t tile,
+        FaceWork &work,
+        std::vector <std::vector <index_t> > &cycles,
+        std::vector <index_t> &leftovers)
+{
+    if (work.mark.size () != network.edges.size ())
+    {
+        work.mark.assign (network.edges.size (), 0L);
+        work.pos.resize (network.edges.size ());
+        work.trace_id = 0;
+    }
+    const index_t first_id = work.trace_id + 1;
+
+    std::vector <index_t> cycle;
+    for (index_t i = tiles.offsets [tile]; i < tiles.offsets [tile + 1]; i++)
+    {
+        const index_t e = tiles.edges [i];
+        if (work.mark [e] >= first_id)
+            continue;
+
+        const FaceTrace res = faces::trace_from (network, rot_pos, &tiles,
+                tile, e, first_id, work, cycle);
+        if (res == FaceTrace::ESCAPED)
+            leftovers.push_back (e);
+        else if (res == FaceTrace::CYCLE)
+        {
+            const OneEdge &e0 = network.edges [cycle.front ()];
+            if (faces::tile_of (tiles, e0.x0, e0.y0) == tile)
+                cycles.push_back (cycle);
+        }
+    }
+}
+
+// 'enumerate' marks edges as visited even in traces which do not return to
+// their start edge. Where edges have no reverse, such a trace may run into a
+// cycle, whose edges are then all visited without the cycle being retained.
+// This removes all cycles which are entered in that way from a lower edge which
+// is not itself in any cycle. 'cycles' must be sorted by their first edges.
+void faces::remove_entered_cycles (const Network &network,
+        const std::vector <index_t> &rot_pos,
+        std::vector <std::vector <index_t> > &cycles)
+{
+    const size_t n = network.edges.size ();
+    if (std::find (network.edge_twin.begin (), network.edge_twin.end (),
+                INFINITE_INDEX) == network.edge_twin.end ())
+        return; // face edges are then a permutation, with no tails
+
+    // Cycle reached from each edge, or INFINITE_INDEX where none is reached:
+    std::vector <index_t> reach (n, INFINITE_INDEX);
+    std::vector <bool> known (n, false), on_cycle (n, false);
+    for (size_t k = 0; k < cycles.size (); k++)
+    {
+        for (auto e: cycles [k])
+        {
+            reach [e] = static_cast <index_t> (k);
+            known [e] = on_cycle [e] = true;
+        }
+    }
+
+    std::vector <index_t> min_tail (cycles.size (), INFINITE_INDEX);
+    std::vector <index_t> chain;
+    for (index_t i = 0; i < n; i++)
+    {
+        if (!known [i])
+        {
+            chain.clear ();
+            index_t e = i;
+            while (e != INFINITE_INDEX && !known [e])
+            {
+                known [e] = true;
+                chain.push_back (e);
+                e = faces::next_face_edge (network, rot_pos, e);
+            }
+            const index_t k = e == INFINITE_INDEX ? INFINITE_INDEX : reach [e];
+            for (auto c: chain)
+                reach [c] = k;
+        }
+        if (!on_cycle [i] && reach [i] != INFINITE_INDEX &&
+                min_tail [reach [i]] == INFINITE_INDEX)
+            min_tail [reach [i]] = i;
+    }
+
+    size_t k_out = 0;
+    for (size_t k = 0; k < cycles.size (); k++)
+    {
+        if (min_tail [k] < cycles [k].front ())
+            continue;
+        if (k_out != k)
+            cycles [k_out] = std::move (cycles [k]);
+        k_out++;
+    }
+    cycles.resize (k_out);
+}
+
+// Enumerate all faces of a network divided into 'ntiles' x 'ntiles' spatial
+// tiles, which are traced in parallel. Traces which leave the halo of their
+// tile are traced again over the whole network once all tiles are done. The
+// result is identical to 'enumerate', including the order of faces and of the
+// edges in each face.
+void faces::enumerate_tiled (const Network &network,
+        const size_t ntiles,
+        const int nthreads,
+        FaceData &faces)
+{
+    if (ntiles <= 1)
+    {
+        faces::enumerate (network, faces);
+        return;
+    }
+
+    std::vector <index_t> rot_pos;
+    faces::fill_rotation_pos (network, rot_pos);
+
+    FaceTiles tiles;
+    faces::build_tiles (network, ntiles, tiles);
+    const size_t n_tiles = tiles.nx * tiles.ny;
+
+    std::vector <std::vector <std::vector <index_t> > > tile_cycles (n_tiles);
+    std::vector <std::vector <index_t> > tile_leftovers (n_tiles);
+    std::vector <FaceWork> work (threads::n_threads (nthreads, n_tiles));
+    threads::parallel_steal (n_tiles, nthreads,
+            [&] (size_t t, size_t tid) {
+                faces::trace_tile (network, rot_pos, tiles, t, work [tid],
+                        tile_cycles [t], tile_leftovers [t]);
+            },
+            [] (size_t) {});
+
+    std::vector <std::vector <index_t> > cycles;
+    std::vector <index_t> leftovers;
+    for (size_t t = 0; t < n_tiles; t++)
+    {
+        for (auto &c: tile_cycles [t])
+            cycles.push_back (std::move (c));
+        leftovers.insert (leftovers.end (), tile_leftovers [t].begin (),
+                tile_leftovers [t].end ());
+    }
+    stats::add (stats::TILE_LEFTOVERS, leftovers.size ());
+
+    // Leftovers are traced over the whole network, and may find cycles also
+    // retained by tiles:
+    std::sort (leftovers.begin (), leftovers.end ());
+    FaceWork global;
+    global.mark.assign (network.edges.size (), 0L);
+    global.pos.resize (network.edges.size ());
+    std::vector <index_t> cycle;
+    for (auto e: leftovers)
+    {
+        if (global.mark [e] > 0)
+            continue;
+        if (faces::trace_from (network, rot_pos, nullptr, 0, e, 1, global,
+                    cycle) == FaceTrace::CYCLE)
+            cycles.push_back (cycle);
+    }
+
+    // Cycles are disjoint, so are uniquely identified by their lowest edges:
+    std::sort (cycles.begin (), cycles.end (),
+            [] (const std::vector <index_t> &a, const std::vector <index_t> &b) {
+                return a.front () < b.front (); });
+    cycles.erase (std::unique (cycles.begin (), cycles.end (),
+                [] (const std::vector <index_t> &a,
+                    const std::vector <index_t> &b) {
+                    return a.front () == b.front (); }),
+            cycles.end ());
+
+    faces::remove_entered_cycles (network, rot_pos, cycles);
+
+    faces.edges.clear ();
+    faces.edges.reserve (network.edges.size ());
+    faces.offsets.assign (1, 0L);
+    faces.area.clear ();
+    for (const auto &c: cycles)
+    {
+        const size_t start = faces.edges.size ();
+        faces.edges.insert (faces.edges.end (), c.begin (), c.end ());
+        faces.offsets.push_back (static_cast <index_t> (faces.edges.size ()));
+        faces.area.push_back (faces::face_area (network, faces.edges,
+                    start, faces.edges.size ()));
+    }
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "typedefs.h"
+#include "cycles.h"
+#include "threads.h"
+
+#include <vector>
+
+// All faces of a network, in compressed sparse row form, so that the edges of
+// face i are edges [offsets [i]:(offsets [i + 1] - 1)].
+struct FaceData
+{
+    std::vector <index_t> edges;
+    std::vector <index_t> offsets;
+    // Signed area, positive for bounded faces traced anticlockwise:
+    std::vector <double> area;
+};
+
+// Width of the halo around each tile, as a fraction of the tile width:
+const double FACE_TILE_HALO = 0.25;
+
+// Square spatial tiles of a network. Each edge is in the core of the tile
+// containing its start vertex, and edges of tile t are
+// edges [offsets [t]:(offsets [t + 1] - 1)], in increasing order. The region of
+// each tile extends beyond its core by a halo of width 'halo_x', 'halo_y'.
+struct FaceTiles
+{
+    size_t nx, ny;
+    double xmin, ymin, dx, dy, halo_x, halo_y;
+    std::vector <index_t> edges;
+    std::vector <index_t> offsets;
+};
+
+// Work arrays for tracing faces, where 'mark' holds the ID of the trace which
+// last visited each edge, and 'pos' the position of each edge in that trace.
+struct FaceWork
+{
+    std::vector <index_t> mark;
+    std::vector <index_t> pos;
+    std::vector <index_t> path;
+    index_t trace_id = 0;
+};
+
+enum class FaceTrace { CYCLE, STOPPED, ESCAPED };
+
+namespace faces {
+
+void fill_rotation_pos (const Network &network,
+        std::vector <index_t> &rot_pos);
+
+index_t next_face_edge (const Network &network,
+        const std::vector <index_t> &rot_pos,
+        const index_t this_edge);
+
+double face_area (const Network &network,
+        const std::vector <index_t> &edges,
+        const size_t from,
+        const size_t to);
+
+void enumerate (const Network &network, FaceData &faces);
+
+size_t tile_of (const FaceTiles &tiles, const double x, const double y);
+
+bool in_region (const FaceTiles &tiles, const size_t tile, const OneEdge &e);
+
+void build_tiles (const Network &network,
+        const size_t ntiles,
+        FaceTiles &tiles);
+
+FaceTrace trace_from (const Network &network,
+        const std::vector <index_t> &rot_pos,
+        const FaceTiles *tiles,
+        const size_t tile,
+        const index_t start,
+        const index_t first_id,
+        FaceWork &work,
+        std::vector <index_t> &cycle);
+
+void trace_tile (const Network &network,
+        const std::vector <index_t> &rot_pos,
+        const FaceTiles &tiles,
+        const size_t tile,
+        FaceWork &work,
+        std::vector <std::vector <index_t> > &cycles,
+        std::vector <index_t> &leftovers);
+
+void remove_entered_cycles (const Network &network,
+        const std::vector <index_t> &rot_pos,
+        std::vector <std::vector <index_t> > &cycles);
+
+void enumerate_tiled (const Network &network,
+        const size_t ntiles,
+        const int nthreads,
+        FaceData &faces);
+
+} // end namespace faces
@@ -0,0 +1,72 @@
+#include "typedefs.h"
+#include "ingest.h"
+#include "grid_index.h"
+#include "stats.h"
+
+#include "cpp11.hpp"
+
+#include <memory> // unique_ptr
+
+using namespace cpp11;
+
+// Build a grid index over the edges of a network with columns of vertex
+// coordinates, returned as an external pointer which can be passed to all
+// subsequent queries.
+[[cpp11::register]]
+SEXP cpp_edge_grid(list df)
+{
+    stats::PhaseTimer timer ("edge_grid");
+
+    const double *x0 = ingest::real_column (df, ".vx0_x");
+    const double *y0 = ingest::real_column (df, ".vx0_y");
+    const double *x1 = ingest::real_column (df, ".vx1_x");
+    const double *y1 = ingest::real_column (df, ".vx1_y");
+    const size_t n = static_cast <size_t> (Rf_xlength (df [".vx0_x"]));
+
+    std::unique_ptr <EdgeGrid> grid (new EdgeGrid);
+    grid_index::build (*grid, x0, y0, x1, y1, n);
+
+    external_pointer <EdgeGrid> ptr (grid.release ());
+
+    return ptr;
+}
+
+// Batch queries of edges within 'dmax' metres of each point (x, y), as for
+// 'cut_networks'. Return value is a list of sorted 1-based edge indices for
+// each point.
+[[cpp11::register]]
+writable::list cpp_grid_radius(SEXP grid, doubles x, doubles y,
+        const double dmax, const int nthreads)
+{
+    stats::PhaseTimer timer ("grid_radius");
+
+    external_pointer <EdgeGrid> ptr (grid);
+    if (ptr.get () == nullptr)
+        cpp11::stop ("Grid index is no longer valid; it must be rebuilt");
+    if (x.size () != y.size ())
+        cpp11::stop ("x and y must have the same lengths");
+
+    const size_t n = static_cast <size_t> (x.size ());
+    std::vector <double> xv (n), yv (n);
+    for (size_t i = 0; i < n; i++)
+    {
+        xv [i] = x [static_cast <R_xlen_t> (i)];
+        yv [i] = y [static_cast <R_xlen_t> (i)];
+    }
+
+    std::vector <index_t> offsets, edges;
+    grid_index::radius_queries (*ptr, xv, yv, dmax, nthreads, offsets, edges);
+
+    writable::list res (static_cast <R_xlen_t> (n));
+    for (size_t i = 0; i < n; i++)
+    {
+        writable::integers edges_i (static_cast <R_xlen_t> (offsets [i + 1] -
+                    offsets [i]));
+        for (index_t j = offsets [i]; j < offsets [i + 1]; j++)
+            edges_i [static_cast <R_xlen_t> (j - offsets [i])] =
+                static_cast <int> (edges [j]) + 1;
+        res [static_cast <R_xlen_t> (i)] = edges_i;
+    }
+
+    return res;
+}
@@ -0,0 +1,222 @@
+#include "grid_index.h"
+#include "polygons.h"
+#include "threads.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Maximal number of cells along each side of a grid:
+const size_t GRID_MAX_CELLS = 1024;
+
+// Build a grid of around one cell per edge over the bounding box of all edges.
+void grid_index::build (EdgeGrid &grid,
+        const double *x0,
+        const double *y0,
+        const double *x1,
+        const double *y1,
+        const size_t n)
+{
+    grid.x0.assign (x0, x0 + n);
+    grid.y0.assign (y0, y0 + n);
+    grid.x1.assign (x1, x1 + n);
+    grid.y1.assign (y1, y1 + n);
+
+    // Edges with any non-finite coordinates are never returned from queries,
+    // and so are not held in the grid:
+    auto finite = [&] (const size_t e) {
+        return std::isfinite (x0 [e]) && std::isfinite (y0 [e]) &&
+            std::isfinite (x1 [e]) && std::isfinite (y1 [e]);
+    };
+
+    double xmin = INFINITY, xmax = -INFINITY, ymin = INFINITY, ymax = -INFINITY;
+    for (size_t i = 0; i < n; i++)
+    {
+        if (!finite (i))
+            continue;
+        xmin = std::min (xmin, std::min (x0 [i], x1 [i]));
+        xmax = std::max (xmax, std::max (x0 [i], x1 [i]));
+        ymin = std::min (ymin, std::min (y0 [i], y1 [i]));
+        ymax = std::max (ymax, std::max (y0 [i], y1 [i]));
+    }
+    if (xmin > xmax)
+        xmin = xmax = ymin = ymax = 0.0;
+
+    const double w = std::max (xmax - xmin, 1.0e-9);
+    const double h = std::max (ymax - ymin, 1.0e-9);
+    const double cell = std::sqrt (w * h / static_cast <double> (std::max (n,
+                    static_cast <size_t> (1))));
+    grid.nx = std::min (GRID_MAX_CELLS,
+            static_cast <size_t> (std::ceil (w / cell)));
+    grid.ny = std::min (GRID_MAX_CELLS,
+            static_cast <size_t> (std::ceil (h / cell)));
+    grid.nx = std::max (grid.nx, static_cast <size_t> (1));
+    grid.ny = std::max (grid.ny, static_cast <size_t> (1));
+    grid.xmin = xmin;
+    grid.ymin = ymin;
+    grid.cell_w = w / static_cast <double> (grid.nx);
+    grid.cell_h = h / static_cast <double> (grid.ny);
+
+    // Cell ranges of each edge, clamped to the grid:
+    auto cell_x = [&] (const double x) {
+        const double c = std::floor ((x - grid.xmin) / grid.cell_w);
+        return static_cast <size_t> (std::min (std::max (c, 0.0),
+                    static_cast <double> (grid.nx - 1)));
+    };
+    auto cell_y = [&] (const double y) {
+        const double c = std::floor ((y - grid.ymin) / grid.cell_h);
+        return static_cast <size_t> (std::min (std::max (c, 0.0),
+                    static_cast <double> (grid.ny - 1)));
+    };
+
+    // Two passes of a counting sort, first counting, then filling edges:
+    grid.cell_offset.assign (grid.nx * grid.ny + 1, 0);
+    grid.cell_edges.clear ();
+    std::vector <index_t> pos;
+    for (int pass = 0; pass < 2; pass++)
+    {
+        for (size_t e = 0; e < n; e++)
+        {
+            if (!finite (e))
+                continue;
+            const size_t i0 = cell_x (std::min (x0 [e], x1 [e]));
+            const size_t i1 = cell_x (std::max (x0 [e], x1 [e]));
+            const size_t j0 = cell_y (std::min (y0 [e], y1 [e]));
+            const size_t j1 = cell_y (std::max (y0 [e], y1 [e]));
+            for (size_t j = j0; j <= j1; j++)
+                for (size_t i = i0; i <= i1; i++)
+                {
+                    if (pass == 0)
+                        grid.cell_offset [j * grid.nx + i + 1]++;
+                    else
+                        grid.cell_edges [pos [j * grid.nx + i]++] =
+                            static_cast <index_t> (e);
+                }
+        }
+        if (pass == 0)
+        {
+            for (size_t c = 0; c < grid.nx * grid.ny; c++)
+                grid.cell_offset [c + 1] += grid.cell_offset [c];
+            grid.cell_edges.resize (grid.cell_offset.back ());
+            pos.assign (grid.cell_offset.begin (), grid.cell_offset.end () - 1);
+        }
+    }
+}
+
+// Half-width in degrees of a square box centred on latitude 'y', for which the
+// haversine distance between opposite corners equals 'dmax' in metres. The
+// distance increases monotonically with half-widths up to one degree, so the
+// half-width is found by bisection.
+double grid_index::haversine_halfwidth (const double y, const double dmax)
+{
+    const double deg2rad = 3.14159265358979323846 / 180.0;
+
+    auto diag = [&] (const double lim) {
+        const double dlat = 2.0 * lim * deg2rad;
+        const double dlon = 2.0 * lim * deg2rad;
+        const double h = std::pow (std::sin (dlat / 2.0), 2.0) +
+            std::cos ((y - lim) * deg2rad) * std::cos ((y + lim) * deg2rad) *
+            std::pow (std::sin (dlon / 2.0), 2.0);
+        return 2.0 * polygons::EARTH_RADIUS *
+            std::asin (std::min (1.0, std::sqrt (h)));
+    };
+
+    double lo = 0.0, hi = 1.0;
+    if (diag (hi) <= dmax)
+        return hi;
+    for (int i = 0; i < 60 && hi - lo > 1.0e-12; i++)
+    {
+        const double mid = (lo + hi) / 2.0;
+        if (diag (mid) < dmax)
+            lo = mid;
+        else
+            hi = mid;
+    }
+
+    return (lo + hi) / 2.0;
+}
+
+// Append to 'edges' all edges with at least one vertex strictly within the
+// x-range, and at least one vertex strictly within the y-range, of a query
+// box. Edges overlapping several cells are found once from each, and
+// duplicates removed after sorting, so queries cost in proportion to the
+// cells and candidate edges they visit. Edges are returned in increasing
+// order.
+void grid_index::query_box (const EdgeGrid &grid,
+        const double xlo,
+        const double xhi,
+        const double ylo,
+        const double yhi,
+        std::vector <index_t> &edges)
+{
+    const size_t n0 = edges.size ();
+    if (grid.x0.empty ())
+        return;
+
+    const double ci0 = std::floor ((xlo - grid.xmin) / grid.cell_w);
+    const double ci1 = std::floor ((xhi - grid.xmin) / grid.cell_w);
+    const double cj0 = std::floor ((ylo - grid.ymin) / grid.cell_h);
+    const double cj1 = std::floor ((yhi - grid.ymin) / grid.cell_h);
+    const double nx = static_cast <double> (grid.nx - 1);
+    const double ny = static_cast <double> (grid.ny - 1);
+    if (ci1 < 0.0 || cj1 < 0.0 || ci0 > nx || cj0 > ny)
+        return;
+
+    const size_t i0 = static_cast <size_t> (std::max (ci0, 0.0));
+    const size_t i1 = static_cast <size_t> (std::min (ci1, nx));
+    const size_t j0 = static_cast <size_t> (std::max (cj0, 0.0));
+    const size_t j1 = static_cast <size_t> (std::min (cj1, ny));
+
+    for (size_t j = j0; j <= j1; j++)
+        for (size_t i = i0; i <= i1; i++)
+        {
+            const size_t c = j * grid.nx + i;
+            for (index_t k = grid.cell_offset [c]; k < grid.cell_offset [c + 1]; k++)
+            {
+                const index_t e = grid.cell_edges [k];
+                const bool in_x = (grid.x0 [e] > xlo && grid.x0 [e] < xhi) ||
+                    (grid.x1 [e] > xlo && grid.x1 [e] < xhi);
+                const bool in_y = (grid.y0 [e] > ylo && grid.y0 [e] < yhi) ||
+                    (grid.y1 [e] > ylo && grid.y1 [e] < yhi);
+                if (in_x && in_y)
+                    edges.push_back (e);
+            }
+        }
+
+    const auto first = edges.begin () + static_cast <std::ptrdiff_t> (n0);
+    std::sort (first, edges.end ());
+    edges.erase (std::unique (first, edges.end ()), edges.end ());
+}
+
+// Edges within 'dmax' metres of each query point (x, y), as boxes with
+// haversine diagonals of 'dmax', split between threads. Edges of query 'i'
+// are in edges [offsets [i]:(offsets [i + 1] - 1)].
+void grid_index::radius_queries (const EdgeGrid &grid,
+        const std::vector <double> &x,
+        const std::vector <double> &y,
+        const double dmax,
+        const int nthreads,
+        std::vector <index_t> &offsets,
+        std::vector <index_t> &edges)
+{
+    const size_t n = x.size ();
+    std::vector <std::vector <index_t> > results (n);
+
+    threads::parallel_for (n, nthreads,
+            [&] (size_t from, size_t to, size_t) {
+                for (size_t i = from; i < to; i++)
+                {
+                    const double lim = grid_index::haversine_halfwidth (y [i],
+                            dmax);
+                    grid_index::query_box (grid, x [i] - lim, x [i] + lim,
+                            y [i] - lim, y [i] + lim, results [i]);
+                }
+            });
+
+    offsets.assign (n + 1, 0);
+    for (size_t i = 0; i < n; i++)
+        offsets [i + 1] = offsets [i] + static_cast <index_t> (results [i].size ());
+    edges.resize (offsets.back ());
+    for (size_t i = 0; i < n; i++)
+        std::copy (results [i].begin (), results [i].end (),
+                edges.begin () + offsets [i]);
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "typedefs.h"
+
+#include <vector>
+
+// Uniform grid over bounding boxes of edges in geographic coordinates. Each
+// edge is held in every cell its bounding box overlaps, with edges of cell
+// (i, j) in cell_edges [cell_offset [j * nx + i]:(cell_offset [j * nx + i + 1] - 1)].
+struct EdgeGrid
+{
+    std::vector <double> x0, y0, x1, y1;
+    double xmin, ymin, cell_w, cell_h;
+    size_t nx, ny;
+    std::vector <index_t> cell_offset;
+    std::vector <index_t> cell_edges;
+};
+
+namespace grid_index {
+
+void build (EdgeGrid &grid,
+        const double *x0,
+        const double *y0,
+        const double *x1,
+        const double *y1,
+        const size_t n);
+
+double haversine_halfwidth (const double y, const double dmax);
+
+void query_box (const EdgeGrid &grid,
+        const double xlo,
+        const double xhi,
+        const double ylo,
+        const double yhi,
+        std::vector <index_t> &edges);
+
+void radius_queries (const EdgeGrid &grid,
+        const std::vector <double> &x,
+        const std::vector <double> &y,
+        const double dmax,
+        const int nthreads,
+        std::vector <index_t> &offsets,
+        std::vector <index_t> &edges);
+
+} // end namespace grid_index
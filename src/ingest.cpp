@@ -0,0 +1,138 @@
+#include "ingest.h"
+
+#include <algorithm> // copy
+
+using namespace cpp11;
+
+// Intern all CHARSXP values of a character vector to dense indices, extending
+// 'char_map' and 'unique_chars' with any new values.
+void ingest::intern_chars (const SEXP strs,
+        CharMap &char_map,
+        std::vector <SEXP> &unique_chars,
+        std::vector <index_t> &result)
+{
+    const R_xlen_t n = Rf_xlength (strs);
+    result.resize (static_cast <size_t> (n));
+    for (R_xlen_t i = 0; i < n; i++)
+    {
+        const SEXP c = STRING_ELT (strs, i);
+        auto it = char_map.emplace (c,
+                static_cast <index_t> (unique_chars.size ()));
+        if (it.second)
+            unique_chars.push_back (c);
+        result [static_cast <size_t> (i)] = it.first->second;
+    }
+}
+
+// Views of all strings of a character vector.
+void ingest::char_views (const SEXP strs, std::vector <CharView> &result)
+{
+    const R_xlen_t n = Rf_xlength (strs);
+    result.resize (static_cast <size_t> (n));
+    for (R_xlen_t i = 0; i < n; i++)
+    {
+        const SEXP c = STRING_ELT (strs, i);
+        result [static_cast <size_t> (i)] =
+            CharView {CHAR (c), static_cast <size_t> (LENGTH (c))};
+    }
+}
+
+// Pointer to the data of a double column, valid for the lifetime of 'df'.
+const double *ingest::real_column (const list &df, const std::string &col)
+{
+    const SEXP x = df [col];
+    if (TYPEOF (x) != REALSXP)
+        cpp11::stop ("Column '%s' must be numeric", col.c_str ());
+    return REAL (x);
+}
+
+// A character column, checked to be of type STRSXP before any of its elements
+// are read with STRING_ELT.
+SEXP ingest::string_column (const list &df, const std::string &col)
+{
+    const SEXP x = df [col];
+    if (TYPEOF (x) != STRSXP)
+        cpp11::stop ("Column '%s' must be character", col.c_str ());
+    return x;
+}
+
+// Convert a view of part of the CHARSXP 'src' back into a CHARSXP, which is
+// 'src' itself where the view covers the whole string.
+SEXP ingest::view_to_char (const CharView &v, const SEXP src)
+{
+    if (v.s == CHAR (src) && v.len == static_cast <size_t> (LENGTH (src)))
+        return src;
+    return Rf_mkCharLenCE (v.s, static_cast <int> (v.len), Rf_getCharCE (src));
+}
+
+// Read all columns of a network, interning vertices by CHARSXP, and holding
+// edge IDs and coordinates as views of the R data.
+void ingest::network_columns (const list &df, NetworkColumns &cols)
+{
+    const SEXP vx0 = ingest::string_column (df, ".vx0");
+    const SEXP vx1 = ingest::string_column (df, ".vx1");
+    const SEXP edges = ingest::string_column (df, "edge_");
+
+    CharMap vert_map;
+    vert_map.reserve (static_cast <size_t> (Rf_xlength (vx0)));
+    std::vector <SEXP> verts;
+    ingest::intern_chars (vx0, vert_map, verts, cols.v0);
+    ingest::intern_chars (vx1, vert_map, verts, cols.v1);
+
+    cols.n_verts = static_cast <index_t> (verts.size ());
+    cols.vert_named.resize (verts.size ());
+    cols.vert_ids.resize (verts.size ());
+    for (size_t i = 0; i < verts.size (); i++)
+    {
+        cols.vert_named [i] = LENGTH (verts [i]) > 0;
+        cols.vert_ids [i] = CharView {CHAR (verts [i]),
+            static_cast <size_t> (LENGTH (verts [i]))};
+    }
+
+    ingest::char_views (edges, cols.edge_ids);
+
+    cols.x0 = ingest::real_column (df, ".vx0_x");
+    cols.y0 = ingest::real_column (df, ".vx0_y");
+    cols.x1 = ingest::real_column (df, ".vx1_x");
+    cols.y1 = ingest::real_column (df, ".vx1_y");
+}
+
+// Coordinates of polygons formed from a list of paths, each of which is a
+// data.frame of consecutive edges. Polygons are formed from all start vertices
+// and the final end vertex of each path, with vertices of path 'i' in
+// lon [offsets [i]:(offsets [i + 1] - 1)] and equivalent 'lat' values.
+void ingest::path_coords (const list &paths,
+        std::vector <double> &lon,
+        std::vector <double> &lat,
+        std::vector <index_t> &offsets)
+{
+    const size_t n = static_cast <size_t> (paths.size ());
+    offsets.assign (n + 1, 0L);
+    for (size_t i = 0; i < n; i++)
+    {
+        const list p = paths [static_cast <R_xlen_t> (i)];
+        const size_t nrow = static_cast <size_t> (Rf_xlength (p [".vx0_x"]));
+        offsets [i + 1] = offsets [i] +
+            static_cast <index_t> (nrow > 0 ? nrow + 1 : 0);
+    }
+
+    lon.resize (offsets.back ());
+    lat.resize (offsets.back ());
+    for (size_t i = 0; i < n; i++)
+    {
+        const size_t npts = offsets [i + 1] - offsets [i];
+        if (npts == 0)
+            continue;
+        const size_t nrow = npts - 1;
+
+        const list p = paths [static_cast <R_xlen_t> (i)];
+        const double *x0 = ingest::real_column (p, ".vx0_x");
+        const double *y0 = ingest::real_column (p, ".vx0_y");
+        const double *x1 = ingest::real_column (p, ".vx1_x");
+        const double *y1 = ingest::real_column (p, ".vx1_y");
+        std::copy (x0, x0 + nrow, lon.begin () + offsets [i]);
+        std::copy (y0, y0 + nrow, lat.begin () + offsets [i]);
+        lon [offsets [i] + nrow] = x1 [nrow - 1];
+        lat [offsets [i] + nrow] = y1 [nrow - 1];
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "typedefs.h"
+#include "utils.h"
+#include "cycles.h"
+
+#include "cpp11.hpp"
+
+#include <vector>
+#include <unordered_map>
+
+// Shared layer to read columns of R data.frames without copying. Strings in R
+// are held in a global cache of CHARSXP values, so that equal strings with
+// the same encoding are always the same CHARSXP. IDs of vertices and edges are
+// ASCII, so can be interned directly by CHARSXP pointer.
+
+typedef std::unordered_map <SEXP, index_t> CharMap;
+
+namespace ingest {
+
+void intern_chars (const SEXP strs,
+        CharMap &char_map,
+        std::vector <SEXP> &unique_chars,
+        std::vector <index_t> &result);
+
+void char_views (const SEXP strs, std::vector <CharView> &result);
+
+const double *real_column (const cpp11::list &df, const std::string &col);
+
+SEXP string_column (const cpp11::list &df, const std::string &col);
+
+SEXP view_to_char (const CharView &v, const SEXP src);
+
+void network_columns (const cpp11::list &df, NetworkColumns &cols);
+
+void path_coords (const cpp11::list &paths,
+        std::vector <double> &lon,
+        std::vector <double> &lat,
+        std::vector <index_t> &offsets);
+
+} // end namespace ingest
@@ -0,0 +1,166 @@
+#include "isolated.h"
+#include "preprocess.h"
+
+#include <algorithm>
+#include <numeric> // iota
+
+// Union-find root with path halving.
+index_t isolated::find_root (std::vector <index_t> &parent, index_t v)
+{
+    while (parent [v] != v)
+    {
+        parent [v] = parent [parent [v]];
+        v = parent [v];
+    }
+    return v;
+}
+
+// Group all vertices connected through undirected edges in any path into
+// components. 'in_path' flags undirected edges which are in paths, and
+// 'vert_comp' holds component numbers, or INFINITE_INDEX for vertices not on
+// any path. Components are numbered in decreasing order of numbers of edges,
+// so that component 0 is the main component.
+void isolated::path_components (const Network &network,
+        const std::vector <std::vector <index_t> > &paths,
+        std::vector <bool> &in_path,
+        std::vector <index_t> &vert_comp,
+        index_t &n_comps)
+{
+    const size_t nverts = network.n_verts;
+
+    in_path.assign (network.n_undir, false);
+    for (const auto &p: paths)
+    {
+        for (auto e: p)
+            in_path [network.edge_undir [e]] = true;
+    }
+
+    std::vector <index_t> parent (nverts);
+    std::iota (parent.begin (), parent.end (), 0);
+    std::vector <bool> on_path (nverts, false);
+    for (const auto &e: network.edges)
+    {
+        if (!in_path [network.edge_undir [e.edge]])
+            continue;
+        on_path [e.v0] = on_path [e.v1] = true;
+        const index_t r0 = isolated::find_root (parent, e.v0);
+        const index_t r1 = isolated::find_root (parent, e.v1);
+        if (r0 != r1)
+            parent [std::max (r0, r1)] = std::min (r0, r1);
+    }
+
+    // Number of edges in each component, counting both directions:
+    std::vector <index_t> comp_size (nverts, 0L);
+    for (const auto &e: network.edges)
+    {
+        if (in_path [network.edge_undir [e.edge]])
+            comp_size [isolated::find_root (parent, e.v0)]++;
+    }
+
+    std::vector <index_t> roots;
+    for (index_t v = 0; v < nverts; v++)
+    {
+        if (on_path [v] && parent [v] == v)
+            roots.push_back (v);
+    }
+    std::stable_sort (roots.begin (), roots.end (),
+            [&comp_size] (index_t i, index_t j) {
+                return comp_size [i] > comp_size [j]; });
+
+    std::vector <index_t> root_comp (nverts, INFINITE_INDEX);
+    for (index_t i = 0; i < roots.size (); i++)
+        root_comp [roots [i]] = i;
+    n_comps = static_cast <index_t> (roots.size ());
+
+    vert_comp.assign (nverts, INFINITE_INDEX);
+    for (index_t v = 0; v < nverts; v++)
+    {
+        if (on_path [v])
+            vert_comp [v] = root_comp [isolated::find_root (parent, v)];
+    }
+}
+
+// Remove all dangling trees from the edges flagged in 'keep'. Vertices with
+// empty IDs are never terminal. Both directions of each undirected edge are
+// removed together.
+void isolated::peel_terminal (const Network &network, std::vector <bool> &keep)
+{
+    const size_t n = network.edges.size ();
+
+    // Peel one representative edge of each undirected edge:
+    std::vector <index_t> undir_edge (network.n_undir, INFINITE_INDEX);
+    std::vector <index_t> v0, v1;
+    for (index_t i = 0; i < n; i++)
+    {
+        const index_t u = network.edge_undir [i];
+        if (!keep [i] || undir_edge [u] != INFINITE_INDEX)
+            continue;
+        undir_edge [u] = static_cast <index_t> (v0.size ());
+        v0.push_back (network.edges [i].v0);
+        v1.push_back (network.edges [i].v1);
+    }
+
+    std::vector <bool> keep_undir (v0.size (), true);
+    preprocess::peel_terminal (v0, v1, network.vert_named, keep_undir);
+
+    for (index_t i = 0; i < n; i++)
+    {
+        const index_t u = undir_edge [network.edge_undir [i]];
+        if (u != INFINITE_INDEX && !keep_undir [u])
+            keep [i] = false;
+    }
+}
+
+// Identify isolated polygons, which are groups of one or more paths connected
+// to the rest of the network through a single vertex. The main component is
+// never isolated. 'keep' flags all edges which remain after removing isolated
+// polygons and then any resultant dangling edges.
+void isolated::isolated_polygons (const Network &network,
+        const std::vector <std::vector <index_t> > &paths,
+        std::vector <bool> &path_isolated,
+        std::vector <bool> &keep)
+{
+    std::vector <bool> in_path;
+    std::vector <index_t> vert_comp;
+    index_t n_comps;
+    isolated::path_components (network, paths, in_path, vert_comp, n_comps);
+
+    // Vertices of each component which also connect to edges not in paths:
+    std::vector <bool> connects (network.n_verts, false);
+    for (const auto &e: network.edges)
+    {
+        if (!in_path [network.edge_undir [e.edge]])
+            connects [e.v0] = connects [e.v1] = true;
+    }
+    std::vector <index_t> nconn (n_comps, 0L);
+    for (index_t v = 0; v < vert_comp.size (); v++)
+    {
+        if (vert_comp [v] != INFINITE_INDEX && connects [v])
+            nconn [vert_comp [v]]++;
+    }
+
+    std::vector <bool> comp_isolated (n_comps, false);
+    for (index_t i = 1; i < n_comps; i++)
+        comp_isolated [i] = nconn [i] == 1L;
+
+    path_isolated.assign (paths.size (), false);
+    std::vector <bool> undir_isolated (network.n_undir, false);
+    for (size_t i = 0; i < paths.size (); i++)
+    {
+        if (paths [i].empty ())
+            continue;
+        const index_t comp = vert_comp [network.edges [paths [i] [0]].v0];
+        if (!comp_isolated [comp])
+            continue;
+        path_isolated [i] = true;
+        for (auto e: paths [i])
+            undir_isolated [network.edge_undir [e]] = true;
+    }
+
+    const size_t n = network.edges.size ();
+    keep.resize (n);
+    for (size_t i = 0; i < n; i++)
+        keep [i] = !undir_isolated [network.edge_undir [i]];
+
+    isolated::peel_terminal (network, keep);
+}
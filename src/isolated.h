@@ -0,0 +1,25 @@
+#pragma once
+
+#include "typedefs.h"
+#include "cycles.h"
+
+#include <vector>
+
+namespace isolated {
+
+index_t find_root (std::vector <index_t> &parent, index_t v);
+
+void path_components (const Network &network,
+        const std::vector <std::vector <index_t> > &paths,
+        std::vector <bool> &in_path,
+        std::vector <index_t> &vert_comp,
+        index_t &n_comps);
+
+void peel_terminal (const Network &network, std::vector <bool> &keep);
+
+void isolated_polygons (const Network &network,
+        const std::vector <std::vector <index_t> > &paths,
+        std::vector <bool> &path_isolated,
+        std::vector <bool> &keep);
+
+} // end namespace isolated
@@ -0,0 +1,63 @@
+#include "typedefs.h"
+#include "kdtree.h"
+#include "stats.h"
+
+#include "cpp11.hpp"
+
+using namespace cpp11;
+
+// The 'k' nearest points of (x, y) to each query point of (qx, qy), from a
+// KD-tree built in O(n log n) time and O(n) memory. Return value is a list of
+// 1-based indices into (x, y), and Euclidean distances, each with 'k'
+// consecutive values for each query point, in order of increasing distance.
+// Indices are NA where there are fewer than 'k' points.
+[[cpp11::register]]
+writable::list cpp_knn(doubles x, doubles y, doubles qx, doubles qy,
+        const int k, const int nthreads)
+{
+    stats::PhaseTimer timer ("knn");
+
+    if (x.size () != y.size () || qx.size () != qy.size ())
+        cpp11::stop ("x and y coordinates must have the same lengths");
+    if (k < 1)
+        cpp11::stop ("k must be positive");
+
+    std::vector <double> xv (static_cast <size_t> (x.size ()));
+    std::vector <double> yv (xv.size ());
+    for (size_t i = 0; i < xv.size (); i++)
+    {
+        xv [i] = x [static_cast <R_xlen_t> (i)];
+        yv [i] = y [static_cast <R_xlen_t> (i)];
+    }
+    std::vector <double> qxv (static_cast <size_t> (qx.size ()));
+    std::vector <double> qyv (qxv.size ());
+    for (size_t i = 0; i < qxv.size (); i++)
+    {
+        qxv [i] = qx [static_cast <R_xlen_t> (i)];
+        qyv [i] = qy [static_cast <R_xlen_t> (i)];
+    }
+
+    KDTree tree;
+    kdtree::build (tree, xv, yv);
+
+    std::vector <index_t> index;
+    std::vector <double> dist;
+    kdtree::knn (tree, qxv, qyv, static_cast <size_t> (k), nthreads,
+            index, dist);
+
+    writable::integers index_out (static_cast <R_xlen_t> (index.size ()));
+    writable::doubles dist_out (static_cast <R_xlen_t> (index.size ()));
+    for (size_t i = 0; i < index.size (); i++)
+    {
+        const R_xlen_t ir = static_cast <R_xlen_t> (i);
+        index_out [ir] = index [i] == INFINITE_INDEX ?
+            NA_INTEGER : static_cast <int> (index [i]) + 1;
+        dist_out [ir] = index [i] == INFINITE_INDEX ? NA_REAL : dist [i];
+    }
+
+    writable::list res (2);
+    res [0] = index_out;
+    res [1] = dist_out;
+
+    return res;
+}
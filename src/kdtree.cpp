@@ -0,0 +1,141 @@
+#include "kdtree.h"
+#include "threads.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Recursively partition order [from:(to - 1)] about its median.
+void kdtree::build_range (KDTree &tree, const size_t from, const size_t to,
+        const bool split_x)
+{
+    if (to - from < 2)
+        return;
+
+    const size_t mid = (from + to) / 2;
+    const std::vector <double> &coord = split_x ? tree.x : tree.y;
+    std::nth_element (tree.order.begin () + static_cast <std::ptrdiff_t> (from),
+            tree.order.begin () + static_cast <std::ptrdiff_t> (mid),
+            tree.order.begin () + static_cast <std::ptrdiff_t> (to),
+            [&] (const index_t a, const index_t b) {
+                return coord [a] < coord [b] ||
+                    (coord [a] == coord [b] && a < b);
+            });
+
+    kdtree::build_range (tree, from, mid, !split_x);
+    kdtree::build_range (tree, mid + 1, to, !split_x);
+}
+
+// Ordering of (squared distance, point) pairs in the heap of nearest points.
+// Ties in distance are broken by point index, so results never depend on the
+// structure of the tree.
+bool kdtree::heap_less (const std::pair <double, index_t> &a,
+        const std::pair <double, index_t> &b)
+{
+    return a.first < b.first || (a.first == b.first && a.second < b.second);
+}
+
+// Depth-first search of the sub-tree over order [from:(to - 1)], maintaining
+// a max-heap of the 'k' nearest points found so far.
+void kdtree::search_range (const KDTree &tree, const size_t from, const size_t to,
+        const bool split_x, const double qx, const double qy, const size_t k,
+        std::vector <std::pair <double, index_t> > &heap)
+{
+    if (from >= to)
+        return;
+
+    const size_t mid = (from + to) / 2;
+    const index_t p = tree.order [mid];
+    const double dx = tree.x [p] - qx;
+    const double dy = tree.y [p] - qy;
+    const std::pair <double, index_t> d (dx * dx + dy * dy, p);
+
+    if (heap.size () < k)
+    {
+        heap.push_back (d);
+        std::push_heap (heap.begin (), heap.end (), kdtree::heap_less);
+    } else if (kdtree::heap_less (d, heap.front ()))
+    {
+        std::pop_heap (heap.begin (), heap.end (), kdtree::heap_less);
+        heap.back () = d;
+        std::push_heap (heap.begin (), heap.end (), kdtree::heap_less);
+    }
+
+    // Search the half containing the query point first, and the other half
+    // only if it can contain points closer than the current k-th nearest:
+    const double diff = split_x ? -dx : -dy;
+    const bool lower_first = diff < 0.0;
+    if (lower_first)
+        kdtree::search_range (tree, from, mid, !split_x, qx, qy, k, heap);
+    else
+        kdtree::search_range (tree, mid + 1, to, !split_x, qx, qy, k, heap);
+
+    if (heap.size () < k || diff * diff <= heap.front ().first)
+    {
+        if (lower_first)
+            kdtree::search_range (tree, mid + 1, to, !split_x, qx, qy, k, heap);
+        else
+            kdtree::search_range (tree, from, mid, !split_x, qx, qy, k, heap);
+    }
+}
+
+// Build a tree in O(n log n) time over the points (x, y).
+void kdtree::build (KDTree &tree,
+        const std::vector <double> &x,
+        const std::vector <double> &y)
+{
+    tree.x = x;
+    tree.y = y;
+    tree.order.resize (x.size ());
+    for (size_t i = 0; i < x.size (); i++)
+        tree.order [i] = static_cast <index_t> (i);
+
+    kdtree::build_range (tree, 0, x.size (), true);
+}
+
+// The 'k' nearest points to (qx, qy), returned in 'heap' as pairs of squared
+// distances and point indices, sorted by increasing distance.
+void kdtree::nearest (const KDTree &tree,
+        const double qx,
+        const double qy,
+        const size_t k,
+        std::vector <std::pair <double, index_t> > &heap)
+{
+    heap.clear ();
+    if (k == 0)
+        return;
+    kdtree::search_range (tree, 0, tree.order.size (), true, qx, qy, k, heap);
+    std::sort_heap (heap.begin (), heap.end (), kdtree::heap_less);
+}
+
+// Batch query of the 'k' nearest points to each query point, split between
+// threads. Indices and Euclidean distances of the nearest points to query
+// 'i' are in index [(i * k):((i + 1) * k - 1)] and equivalent 'dist' values,
+// with INFINITE_INDEX and infinite distances where the tree has fewer than
+// 'k' points.
+void kdtree::knn (const KDTree &tree,
+        const std::vector <double> &qx,
+        const std::vector <double> &qy,
+        const size_t k,
+        const int nthreads,
+        std::vector <index_t> &index,
+        std::vector <double> &dist)
+{
+    const size_t n = qx.size ();
+    index.assign (n * k, INFINITE_INDEX);
+    dist.assign (n * k, INFINITY);
+
+    threads::parallel_for (n, nthreads,
+            [&] (size_t from, size_t to, size_t) {
+                std::vector <std::pair <double, index_t> > heap;
+                heap.reserve (k);
+                for (size_t i = from; i < to; i++)
+                {
+                    kdtree::nearest (tree, qx [i], qy [i], k, heap);
+                    for (size_t j = 0; j < heap.size (); j++)
+                    {
+                        index [i * k + j] = heap [j].second;
+                        dist [i * k + j] = std::sqrt (heap [j].first);
+                    }
+                }
+            });
+}
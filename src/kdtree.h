@@ -0,0 +1,48 @@
+#pragma once
+
+#include "typedefs.h"
+
+#include <vector>
+
+// Static two-dimensional KD-tree, held implicitly in a single array of point
+// indices. The root of each sub-tree over order [from:(to - 1)] is the median
+// point at order [(from + to) / 2], with lower and upper halves split
+// alternately on x and y coordinates.
+struct KDTree
+{
+    std::vector <double> x;
+    std::vector <double> y;
+    std::vector <index_t> order;
+};
+
+namespace kdtree {
+
+void build_range (KDTree &tree, const size_t from, const size_t to,
+        const bool split_x);
+
+bool heap_less (const std::pair <double, index_t> &a,
+        const std::pair <double, index_t> &b);
+
+void search_range (const KDTree &tree, const size_t from, const size_t to,
+        const bool split_x, const double qx, const double qy, const size_t k,
+        std::vector <std::pair <double, index_t> > &heap);
+
+void build (KDTree &tree,
+        const std::vector <double> &x,
+        const std::vector <double> &y);
+
+void nearest (const KDTree &tree,
+        const double qx,
+        const double qy,
+        const size_t k,
+        std::vector <std::pair <double, index_t> > &heap);
+
+void knn (const KDTree &tree,
+        const std::vector <double> &qx,
+        const std::vector <double> &qy,
+        const size_t k,
+        const int nthreads,
+        std::vector <index_t> &index,
+        std::vector <double> &dist);
+
+} // end namespace kdtree
@@ -0,0 +1,166 @@
+#include "typedefs.h"
+#include "ingest.h"
+#include "cycles.h"
+#include "expand_edges.h"
+#include "netfile.h"
+#include "stats.h"
+
+#include "cpp11.hpp"
+
+#include <memory> // unique_ptr
+
+using namespace cpp11;
+
+// Character vector of all strings of a table read from a network file.
+writable::strings netfile_strings (const StringView &v)
+{
+    writable::strings out (static_cast <R_xlen_t> (v.n));
+    for (size_t i = 0; i < v.n; i++)
+    {
+        const CharView c = netfile::string_at (v, i);
+        SET_STRING_ELT (out, static_cast <R_xlen_t> (i),
+                Rf_mkCharLenCE (c.s, static_cast <int> (c.len), CE_UTF8));
+    }
+    return out;
+}
+
+// Build a network from the data.frame passed from R, and write it to 'path'
+// along with the edge map of the contracted graph from which it was derived,
+// which is either the "edge_map" table of the graph, or NULL, and the
+// "hashc" of that graph, or an empty string.
+[[cpp11::register]]
+void cpp_write_network(list df, SEXP edge_map_in, const std::string hash,
+        const std::string path)
+{
+    stats::PhaseTimer timer ("write_network");
+
+    NetworkColumns cols;
+    ingest::network_columns (df, cols);
+    Network network;
+    build_network::fill_network (network, cols);
+
+    NetTables tables;
+    for (const auto &v: cols.edge_ids)
+        netfile::add_string (tables.edge_ids, v);
+    for (const auto &v: cols.vert_ids)
+        netfile::add_string (tables.vert_ids, v);
+    if (!hash.empty ())
+        netfile::add_string (tables.hash,
+                CharView {hash.c_str (), hash.size ()});
+
+    if (!Rf_isNull (edge_map_in))
+    {
+        const list emap_in (edge_map_in);
+        EdgeMapHandle handle;
+        handle.edge_new = strings (emap_in ["edge_new"]);
+        handle.edge_old = strings (emap_in ["edge_old"]);
+
+        std::vector <index_t> new_index;
+        expand_edges::fill_new_map (handle, new_index);
+        edge_map::build (new_index,
+                static_cast <index_t> (handle.new_map.size ()), tables.emap);
+
+        std::vector <CharView> new_ids (handle.new_map.size ());
+        for (const auto &m: handle.new_map)
+            new_ids [m.second] = m.first;
+        for (const auto &v: new_ids)
+            netfile::add_string (tables.map_new, v);
+
+        std::vector <CharView> old_ids;
+        ingest::char_views (handle.edge_old, old_ids);
+        for (const auto &v: old_ids)
+            netfile::add_string (tables.map_old, v);
+    }
+
+    if (!netfile::write (path, network, tables))
+        cpp11::stop ("Unable to write network file '%s'", path.c_str ());
+}
+
+// Read a network file written by 'cpp_write_network'. Return value is a list
+// of the native network, as for 'cpp_network'; a list of the network columns
+// from which it was built; the native edge map, as for 'cpp_edge_map', or NULL
+// where the file has none; and the "hashc" of the contracted graph, or an
+// empty string.
+[[cpp11::register]]
+writable::list cpp_read_network(const std::string path)
+{
+    stats::PhaseTimer timer ("read_network");
+
+    const MappedFile file (path);
+    std::string err;
+    if (!netfile::validate (file, err))
+        cpp11::stop ("Unable to read network file '%s': %s", path.c_str (),
+                err.c_str ());
+
+    std::unique_ptr <Network> network (new Network);
+    netfile::read_network (file, *network);
+    const size_t n = network->edges.size ();
+
+    const writable::strings verts = netfile_strings (
+            netfile::read_strings (file, VERT_ID_CHARS));
+    writable::strings vx0 (static_cast <R_xlen_t> (n)),
+        vx1 (static_cast <R_xlen_t> (n));
+    writable::doubles x0 (static_cast <R_xlen_t> (n)),
+        y0 (static_cast <R_xlen_t> (n)), x1 (static_cast <R_xlen_t> (n)),
+        y1 (static_cast <R_xlen_t> (n));
+    for (size_t i = 0; i < n; i++)
+    {
+        const OneEdge &e = network->edges [i];
+        const R_xlen_t ir = static_cast <R_xlen_t> (i);
+        SET_STRING_ELT (vx0, ir, STRING_ELT (verts,
+                    static_cast <R_xlen_t> (e.v0)));
+        SET_STRING_ELT (vx1, ir, STRING_ELT (verts,
+                    static_cast <R_xlen_t> (e.v1)));
+        x0 [ir] = e.x0;
+        y0 [ir] = e.y0;
+        x1 [ir] = e.x1;
+        y1 [ir] = e.y1;
+    }
+
+    writable::list edges (7);
+    edges [0] = vx0;
+    edges [1] = vx1;
+    edges [2] = netfile_strings (netfile::read_strings (file, EDGE_ID_CHARS));
+    edges [3] = x0;
+    edges [4] = y0;
+    edges [5] = x1;
+    edges [6] = y1;
+    const char *cols [] = {".vx0", ".vx1", "edge_", ".vx0_x", ".vx0_y",
+        ".vx1_x", ".vx1_y"};
+    writable::strings col_names (7);
+    for (R_xlen_t i = 0; i < 7; i++)
+        col_names [i] = cols [i];
+    edges.names () = col_names;
+
+    sexp edge_map = R_NilValue;
+    if (netfile::section (file, MAP_OFFSETS).size > 0)
+    {
+        std::unique_ptr <EdgeMapHandle> handle (new EdgeMapHandle);
+        handle->edge_new = netfile_strings (
+                netfile::read_strings (file, MAP_NEW_CHARS));
+        handle->edge_old = netfile_strings (
+                netfile::read_strings (file, MAP_OLD_CHARS));
+        std::vector <index_t> new_index;
+        expand_edges::fill_new_map (*handle, new_index);
+        netfile::read_edge_map (file, handle->emap);
+
+        external_pointer <EdgeMapHandle> map_ptr (handle.release ());
+        edge_map = static_cast <SEXP> (map_ptr);
+    }
+
+    const StringView hash_view = netfile::read_strings (file, HASH_CHARS);
+    writable::strings hash (1);
+    hash [0] = "";
+    if (hash_view.n == 1)
+        hash = netfile_strings (hash_view);
+
+    external_pointer <Network> ptr (network.release ());
+
+    writable::list res (4);
+    res [0] = ptr;
+    res [1] = edges;
+    res [2] = edge_map;
+    res [3] = hash;
+
+    return res;
+}
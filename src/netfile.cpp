@@ -0,0 +1,406 @@
+#include "netfile.h"
+
+#include <cstdio>
+#include <cstring> // memcpy, memcmp
+
+#ifdef _WIN32
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Files are memory-mapped on POSIX systems, and read into memory on Windows.
+MappedFile::MappedFile (const std::string &path)
+{
+#ifdef _WIN32
+    std::ifstream in (path, std::ios::binary | std::ios::ate);
+    if (!in)
+        return;
+    const std::streamoff n = in.tellg ();
+    if (n <= 0)
+        return;
+    buffer.resize (static_cast <size_t> (n));
+    in.seekg (0);
+    if (!in.read (buffer.data (), n))
+        return;
+    ptr = buffer.data ();
+    len = buffer.size ();
+#else
+    const int fd = open (path.c_str (), O_RDONLY);
+    if (fd < 0)
+        return;
+    struct stat st;
+    if (fstat (fd, &st) == 0 && st.st_size > 0)
+    {
+        void *p = mmap (nullptr, static_cast <size_t> (st.st_size), PROT_READ,
+                MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED)
+        {
+            ptr = static_cast <const char *> (p);
+            len = static_cast <size_t> (st.st_size);
+        }
+    }
+    close (fd);
+#endif
+}
+
+MappedFile::~MappedFile ()
+{
+#ifndef _WIN32
+    if (ptr != nullptr)
+        munmap (const_cast <char *> (ptr), len);
+#endif
+}
+
+void netfile::add_string (StringTable &table, const CharView &v)
+{
+    table.chars.insert (table.chars.end (), v.s, v.s + v.len);
+    table.offsets.push_back (table.chars.size ());
+}
+
+CharView netfile::string_at (const StringView &view, const size_t i)
+{
+    return CharView {view.chars + view.offsets [i],
+        static_cast <size_t> (view.offsets [i + 1] - view.offsets [i])};
+}
+
+// Write a network and its tables, returning false if the file could not be
+// written. Sections are written in order, each padded to 8 bytes.
+bool netfile::write (const std::string &path,
+        const Network &network,
+        const NetTables &tables)
+{
+    std::vector <std::uint8_t> vert_named (network.vert_named.size ());
+    for (size_t i = 0; i < vert_named.size (); i++)
+        vert_named [i] = network.vert_named [i] ? 1 : 0;
+
+    // Edges are copied field by field into zeroed records, so that the
+    // padding bytes of each 'OneEdge' are written as zeros, and files are
+    // reproducible:
+    std::vector <OneEdge> edges (network.edges.size ());
+    std::memset (static_cast <void *> (edges.data ()), 0,
+            edges.size () * sizeof (OneEdge));
+    for (size_t i = 0; i < edges.size (); i++)
+    {
+        const OneEdge &e = network.edges [i];
+        edges [i].x0 = e.x0;
+        edges [i].y0 = e.y0;
+        edges [i].x1 = e.x1;
+        edges [i].y1 = e.y1;
+        edges [i].v0 = e.v0;
+        edges [i].v1 = e.v1;
+        edges [i].edge = e.edge;
+    }
+
+    std::vector <std::pair <const void *, size_t> > data (N_SECTIONS);
+    auto set = [&data] (const NetSection s, const void *p, const size_t n) {
+        data [s] = std::make_pair (p, n);
+    };
+    set (EDGES, edges.data (), edges.size () * sizeof (OneEdge));
+    set (VERT_NAMED, vert_named.data (), vert_named.size ());
+    set (EDGE_UNDIR, network.edge_undir.data (),
+            network.edge_undir.size () * sizeof (index_t));
+    set (UNDIR_KEY, network.undir_key.data (),
+            network.undir_key.size () * sizeof (CycleKey));
+    set (EDGE_TWIN, network.edge_twin.data (),
+            network.edge_twin.size () * sizeof (index_t));
+    set (OUT_OFFSET, network.out_offset.data (),
+            network.out_offset.size () * sizeof (index_t));
+    set (OUT_EDGES, network.out_edges.data (),
+            network.out_edges.size () * sizeof (index_t));
+    set (NEXT_LEFT, network.next_left.data (),
+            network.next_left.size () * sizeof (index_t));
+    set (NEXT_RIGHT, network.next_right.data (),
+            network.next_right.size () * sizeof (index_t));
+    set (EDGE_ORDER, network.edge_order.data (),
+            network.edge_order.size () * sizeof (index_t));
+    set (EDGE_RANK, network.edge_rank.data (),
+            network.edge_rank.size () * sizeof (index_t));
+
+    const StringTable *strs [] = {&tables.edge_ids, &tables.vert_ids,
+        &tables.map_new, &tables.map_old, &tables.hash};
+    for (size_t i = 0; i < 5; i++)
+    {
+        const NetSection s = static_cast <NetSection> (EDGE_ID_CHARS + 2 * i);
+        set (s, strs [i]->chars.data (), strs [i]->chars.size ());
+        set (static_cast <NetSection> (s + 1), strs [i]->offsets.data (),
+                strs [i]->offsets.size () * sizeof (std::uint64_t));
+    }
+    set (MAP_OFFSETS, tables.emap.offsets.data (),
+            tables.emap.offsets.size () * sizeof (index_t));
+    set (MAP_EDGES_OLD, tables.emap.edges_old.data (),
+            tables.emap.edges_old.size () * sizeof (index_t));
+
+    NetFileHeader header;
+    std::memcpy (header.magic, NETFILE_MAGIC, sizeof (header.magic));
+    header.version = NETFILE_VERSION;
+    header.byte_order = NETFILE_BYTE_ORDER;
+    header.edge_size = sizeof (OneEdge);
+    header.key_size = sizeof (CycleKey);
+    header.n_sections = N_SECTIONS;
+    header.n_verts = network.n_verts;
+    header.n_undir = network.n_undir;
+    header.reserved = 0;
+
+    std::vector <NetFileSection> sections (N_SECTIONS);
+    std::uint64_t offset = sizeof (NetFileHeader) +
+        N_SECTIONS * sizeof (NetFileSection);
+    for (size_t s = 0; s < N_SECTIONS; s++)
+    {
+        offset = (offset + 7) & ~static_cast <std::uint64_t> (7);
+        sections [s].offset = offset;
+        sections [s].size = data [s].second;
+        offset += data [s].second;
+    }
+
+    std::FILE *f = std::fopen (path.c_str (), "wb");
+    if (f == nullptr)
+        return false;
+
+    bool ok = std::fwrite (&header, sizeof (header), 1, f) == 1 &&
+        std::fwrite (sections.data (), sizeof (NetFileSection), N_SECTIONS,
+                f) == N_SECTIONS;
+    const char pad [8] = {0};
+    std::uint64_t pos = sizeof (NetFileHeader) +
+        N_SECTIONS * sizeof (NetFileSection);
+    for (size_t s = 0; s < N_SECTIONS && ok; s++)
+    {
+        const size_t npad = static_cast <size_t> (sections [s].offset - pos);
+        ok = std::fwrite (pad, 1, npad, f) == npad;
+        if (ok && data [s].second > 0)
+            ok = std::fwrite (data [s].first, 1, data [s].second, f) ==
+                data [s].second;
+        pos = sections [s].offset + sections [s].size;
+    }
+
+    return std::fclose (f) == 0 && ok;
+}
+
+// Check that a file is a complete network file of the current version,
+// written on a platform with the same byte order and structure layouts.
+bool netfile::validate (const MappedFile &file, std::string &err)
+{
+    if (file.data () == nullptr)
+    {
+        err = "file can not be read";
+        return false;
+    }
+    const size_t table_end = sizeof (NetFileHeader) +
+        N_SECTIONS * sizeof (NetFileSection);
+    NetFileHeader header;
+    if (file.size () < sizeof (NetFileHeader))
+    {
+        err = "file is not a network file";
+        return false;
+    }
+    std::memcpy (&header, file.data (), sizeof (header));
+    if (std::memcmp (header.magic, NETFILE_MAGIC, sizeof (header.magic)) != 0)
+    {
+        err = "file is not a network file";
+        return false;
+    }
+    if (header.version != NETFILE_VERSION)
+    {
+        err = "network file is version " + std::to_string (header.version) +
+            ", but only version " + std::to_string (NETFILE_VERSION) +
+            " can be read";
+        return false;
+    }
+    if (header.byte_order != NETFILE_BYTE_ORDER ||
+            header.edge_size != sizeof (OneEdge) ||
+            header.key_size != sizeof (CycleKey) ||
+            header.n_sections != N_SECTIONS || file.size () < table_end)
+    {
+        err = "network file was written on an incompatible platform";
+        return false;
+    }
+
+    for (size_t s = 0; s < N_SECTIONS; s++)
+    {
+        const NetFileSection &sec =
+            netfile::section (file, static_cast <NetSection> (s));
+        if (sec.offset % 8 != 0 || sec.offset < table_end ||
+                sec.offset > file.size () ||
+                sec.size > file.size () - sec.offset)
+        {
+            err = "network file is truncated or corrupt";
+            return false;
+        }
+    }
+
+    // Sizes of all arrays must be consistent:
+    const size_t n = netfile::section (file, EDGES).size / sizeof (OneEdge);
+    const size_t nv = header.n_verts;
+    auto n_index = [&file] (const NetSection s) {
+        return netfile::section (file, s).size / sizeof (index_t);
+    };
+    bool ok = netfile::section (file, EDGES).size % sizeof (OneEdge) == 0 &&
+        netfile::section (file, VERT_NAMED).size == nv &&
+        n_index (EDGE_UNDIR) == n && n_index (EDGE_TWIN) == n &&
+        netfile::section (file, UNDIR_KEY).size ==
+            header.n_undir * sizeof (CycleKey) &&
+        n_index (OUT_OFFSET) == nv + 1 && n_index (OUT_EDGES) == n &&
+        n_index (NEXT_LEFT) == n &&
+        n_index (NEXT_RIGHT) == n && n_index (EDGE_ORDER) == n &&
+        n_index (EDGE_RANK) == n;
+    for (size_t s = EDGE_ID_CHARS; ok && s < MAP_OFFSETS; s += 2)
+    {
+        const NetFileSection &sec_off =
+            netfile::section (file, static_cast <NetSection> (s + 1));
+        ok = sec_off.size >= sizeof (std::uint64_t) &&
+            sec_off.size % sizeof (std::uint64_t) == 0;
+        if (!ok)
+            break;
+        const StringView v = netfile::read_strings (file,
+                static_cast <NetSection> (s));
+        ok = v.offsets [0] == 0 && v.offsets [v.n] ==
+            netfile::section (file, static_cast <NetSection> (s)).size;
+        for (size_t i = 0; ok && i < v.n; i++)
+            ok = v.offsets [i] <= v.offsets [i + 1];
+    }
+    ok = ok && netfile::read_strings (file, EDGE_ID_CHARS).n == n &&
+        netfile::read_strings (file, VERT_ID_CHARS).n == nv &&
+        (n_index (MAP_OFFSETS) == 0 || n_index (MAP_OFFSETS) ==
+         netfile::read_strings (file, MAP_NEW_CHARS).n + 1) &&
+        n_index (MAP_EDGES_OLD) == netfile::read_strings (file,
+                MAP_OLD_CHARS).n;
+
+    // All indices must be within bounds:
+    const size_t n_old = n_index (MAP_EDGES_OLD);
+    ok = ok &&
+        netfile::check_indices (file, EDGE_UNDIR, header.n_undir, false) &&
+        netfile::check_indices (file, EDGE_TWIN, n, true) &&
+        netfile::check_offsets (file, OUT_OFFSET, n, false) &&
+        netfile::check_indices (file, OUT_EDGES, n, false) &&
+        netfile::check_indices (file, NEXT_LEFT, n, true) &&
+        netfile::check_indices (file, NEXT_RIGHT, n, true) &&
+        netfile::check_indices (file, EDGE_ORDER, n, false) &&
+        netfile::check_indices (file, EDGE_RANK, n, false) &&
+        netfile::check_offsets (file, MAP_OFFSETS, n_old, true) &&
+        netfile::check_indices (file, MAP_EDGES_OLD, n_old, false);
+    for (size_t i = 0; ok && i < n; i++)
+    {
+        OneEdge e;
+        std::memcpy (&e, file.data () + netfile::section (file, EDGES).offset +
+                i * sizeof (OneEdge), sizeof (OneEdge));
+        ok = e.v0 < nv && e.v1 < nv;
+    }
+    if (!ok)
+    {
+        err = "network file has inconsistent sections";
+        return false;
+    }
+
+    return true;
+}
+
+// Check that all values of an index section are less than 'bound', or
+// optionally INFINITE_INDEX.
+bool netfile::check_indices (const MappedFile &file, const NetSection s,
+        const size_t bound, const bool allow_infinite)
+{
+    const NetFileSection &sec = netfile::section (file, s);
+    const size_t n = static_cast <size_t> (sec.size / sizeof (index_t));
+    for (size_t i = 0; i < n; i++)
+    {
+        index_t x;
+        std::memcpy (&x, file.data () + sec.offset + i * sizeof (index_t),
+                sizeof (index_t));
+        if (x >= bound && !(allow_infinite && x == INFINITE_INDEX))
+            return false;
+    }
+
+    return true;
+}
+
+// Check that a section of offsets starts at 0, is non-decreasing, and ends at
+// 'last'. Empty sections are also valid where 'allow_empty' is true.
+bool netfile::check_offsets (const MappedFile &file, const NetSection s,
+        const size_t last, const bool allow_empty)
+{
+    const NetFileSection &sec = netfile::section (file, s);
+    const size_t n = static_cast <size_t> (sec.size / sizeof (index_t));
+    if (n == 0)
+        return allow_empty;
+
+    index_t prev = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        index_t x;
+        std::memcpy (&x, file.data () + sec.offset + i * sizeof (index_t),
+                sizeof (index_t));
+        if ((i == 0 && x != 0) || x < prev)
+            return false;
+        prev = x;
+    }
+
+    return prev == last;
+}
+
+const NetFileSection &netfile::section (const MappedFile &file,
+        const NetSection s)
+{
+    const NetFileSection *sections = reinterpret_cast <const NetFileSection *> (
+            file.data () + sizeof (NetFileHeader));
+    return sections [s];
+}
+
+template <typename T>
+void netfile::read_array (const MappedFile &file, const NetSection s,
+        std::vector <T> &x)
+{
+    const NetFileSection &sec = netfile::section (file, s);
+    x.resize (static_cast <size_t> (sec.size / sizeof (T)));
+    if (!x.empty ())
+        std::memcpy (x.data (), file.data () + sec.offset,
+                x.size () * sizeof (T));
+}
+
+// Read a network from a file which has been validated. All arrays are
+// copied directly from the file data.
+void netfile::read_network (const MappedFile &file, Network &network)
+{
+    NetFileHeader header;
+    std::memcpy (&header, file.data (), sizeof (header));
+    network.n_verts = header.n_verts;
+    network.n_undir = header.n_undir;
+
+    netfile::read_array (file, EDGES, network.edges);
+    std::vector <std::uint8_t> vert_named;
+    netfile::read_array (file, VERT_NAMED, vert_named);
+    network.vert_named.assign (vert_named.begin (), vert_named.end ());
+    netfile::read_array (file, EDGE_UNDIR, network.edge_undir);
+    netfile::read_array (file, UNDIR_KEY, network.undir_key);
+    netfile::read_array (file, EDGE_TWIN, network.edge_twin);
+    netfile::read_array (file, OUT_OFFSET, network.out_offset);
+    netfile::read_array (file, OUT_EDGES, network.out_edges);
+    netfile::read_array (file, NEXT_LEFT, network.next_left);
+    netfile::read_array (file, NEXT_RIGHT, network.next_right);
+    netfile::read_array (file, EDGE_ORDER, network.edge_order);
+    netfile::read_array (file, EDGE_RANK, network.edge_rank);
+}
+
+// View of a string table held in the sections 'chars' and 'chars + 1'.
+StringView netfile::read_strings (const MappedFile &file, const NetSection chars)
+{
+    const NetFileSection &sec_chars = netfile::section (file, chars);
+    const NetFileSection &sec_off = netfile::section (file,
+            static_cast <NetSection> (chars + 1));
+
+    StringView v;
+    v.chars = file.data () + sec_chars.offset;
+    v.offsets = reinterpret_cast <const std::uint64_t *> (
+            file.data () + sec_off.offset);
+    v.n = static_cast <size_t> (sec_off.size / sizeof (std::uint64_t)) - 1;
+
+    return v;
+}
+
+void netfile::read_edge_map (const MappedFile &file, EdgeMap &emap)
+{
+    netfile::read_array (file, MAP_OFFSETS, emap.offsets);
+    netfile::read_array (file, MAP_EDGES_OLD, emap.edges_old);
+}
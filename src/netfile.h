@@ -0,0 +1,152 @@
+#pragma once
+
+#include "typedefs.h"
+#include "cycles.h"
+#include "edge_map.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Versioned binary files of networks, holding all arrays of a 'Network' along
+// with string tables of vertex and edge IDs, and the edge map of the
+// contracted graph from which the network was built. Files start with a
+// header and a table of sections, each of which is a contiguous array aligned
+// to 8 bytes, so files can be memory-mapped and read without parsing. Files
+// are specific to the byte order and structure layouts of the platform which
+// wrote them.
+
+const char NETFILE_MAGIC [8] = {'N', 'B', 'H', 'D', 'N', 'E', 'T', '\0'};
+const std::uint32_t NETFILE_VERSION = 1;
+const std::uint32_t NETFILE_BYTE_ORDER = 0x01020304;
+
+enum NetSection
+{
+    EDGES = 0,
+    VERT_NAMED,
+    EDGE_UNDIR,
+    UNDIR_KEY,
+    EDGE_TWIN,
+    OUT_OFFSET,
+    OUT_EDGES,
+    NEXT_LEFT,
+    NEXT_RIGHT,
+    EDGE_ORDER,
+    EDGE_RANK,
+    // String tables are pairs of sections of characters and offsets:
+    EDGE_ID_CHARS,
+    EDGE_ID_OFFSETS,
+    VERT_ID_CHARS,
+    VERT_ID_OFFSETS,
+    MAP_NEW_CHARS,
+    MAP_NEW_OFFSETS,
+    MAP_OLD_CHARS,
+    MAP_OLD_OFFSETS,
+    HASH_CHARS,
+    HASH_OFFSETS,
+    MAP_OFFSETS,
+    MAP_EDGES_OLD,
+    N_SECTIONS
+};
+
+struct NetFileHeader
+{
+    char magic [8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    std::uint32_t edge_size;
+    std::uint32_t key_size;
+    std::uint32_t n_sections;
+    std::uint32_t n_verts;
+    std::uint32_t n_undir;
+    std::uint32_t reserved;
+};
+
+struct NetFileSection
+{
+    std::uint64_t offset;
+    std::uint64_t size; // in bytes
+};
+
+// Table of strings, where string 'i' is chars [offsets [i]:(offsets [i + 1] -
+// 1)]. Tables read from files are views of the file data.
+struct StringTable
+{
+    std::vector <char> chars;
+    std::vector <std::uint64_t> offsets = std::vector <std::uint64_t> (1, 0);
+};
+
+struct StringView
+{
+    const char *chars;
+    const std::uint64_t *offsets;
+    size_t n;
+};
+
+// Contents of a network file in addition to the network itself. The edge map
+// may be empty, with 'map_new' holding the unique IDs of contracted edges in
+// the order in which they are indexed in 'emap', and 'map_old' the IDs of all
+// original edges.
+struct NetTables
+{
+    StringTable edge_ids;
+    StringTable vert_ids;
+    StringTable map_new;
+    StringTable map_old;
+    StringTable hash;
+    EdgeMap emap;
+};
+
+// Read-only view of a whole file, which is memory-mapped where possible, or
+// otherwise read into memory. 'data' is null if the file could not be read.
+class MappedFile
+{
+    public:
+
+        explicit MappedFile (const std::string &path);
+        ~MappedFile ();
+
+        MappedFile (const MappedFile &) = delete;
+        MappedFile &operator= (const MappedFile &) = delete;
+
+        const char *data () const { return ptr; }
+        size_t size () const { return len; }
+
+    private:
+
+        const char *ptr = nullptr;
+        size_t len = 0;
+        std::vector <char> buffer;
+};
+
+namespace netfile {
+
+void add_string (StringTable &table, const CharView &v);
+
+CharView string_at (const StringView &view, const size_t i);
+
+bool write (const std::string &path,
+        const Network &network,
+        const NetTables &tables);
+
+bool validate (const MappedFile &file, std::string &err);
+
+bool check_indices (const MappedFile &file, const NetSection s,
+        const size_t bound, const bool allow_infinite);
+
+bool check_offsets (const MappedFile &file, const NetSection s,
+        const size_t last, const bool allow_empty);
+
+const NetFileSection &section (const MappedFile &file, const NetSection s);
+
+template <typename T>
+void read_array (const MappedFile &file, const NetSection s,
+        std::vector <T> &x);
+
+void read_network (const MappedFile &file, Network &network);
+
+StringView read_strings (const MappedFile &file, const NetSection chars);
+
+void read_edge_map (const MappedFile &file, EdgeMap &emap);
+
+} // end namespace netfile
@@ -0,0 +1,107 @@
+#include "typedefs.h"
+#include "pair_stats.h"
+#include "stats.h"
+
+#include "cpp11.hpp"
+
+#include <cmath>
+
+using namespace cpp11;
+
+// 0-based indices from 1-based R integers, with NA values as INFINITE_INDEX.
+void pair_stats_indices (const integers &x, std::vector <index_t> &index)
+{
+    index.resize (static_cast <size_t> (x.size ()));
+    for (size_t i = 0; i < index.size (); i++)
+    {
+        const int xi = x [static_cast <R_xlen_t> (i)];
+        index [i] = xi == NA_INTEGER || xi < 1 ?
+            INFINITE_INDEX : static_cast <index_t> (xi - 1);
+    }
+}
+
+// Offsets of compressed sparse row vectors, from R integers starting at 0.
+void pair_stats_offsets (const integers &x, std::vector <index_t> &offsets)
+{
+    offsets.resize (static_cast <size_t> (x.size ()));
+    for (size_t i = 0; i < offsets.size (); i++)
+        offsets [i] = static_cast <index_t> (x [static_cast <R_xlen_t> (i)]);
+}
+
+// Statistics of all pairs of neighbourhoods, from paths and shared edges of
+// each pair as 1-based indices into the per-edge vectors of 'd',
+// 'centrality', and 'highway', with 'highway' as 1-based integer codes. Paths
+// and shared edges are in flat vectors, with offsets starting at 0 for each
+// path or pair. Return value is a list of a vector of 14 statistics for each
+// pair, and of 1-based modal highway codes of shared edges, and of the
+// non-shared edges of the "from" and "to" paths.
+[[cpp11::register]]
+writable::list cpp_pair_stats(integers path_edges, integers path_offsets,
+        integers from, integers to, integers shared_edges,
+        integers shared_offsets, doubles d, doubles centrality,
+        integers highway, const int n_highway, const int nthreads)
+{
+    stats::PhaseTimer timer ("pair_stats");
+
+    if (d.size () != centrality.size () || d.size () != highway.size ())
+        cpp11::stop ("d, centrality, and highway must have the same lengths");
+    if (from.size () != to.size () ||
+            shared_offsets.size () != from.size () + 1)
+        cpp11::stop ("from, to, and shared_offsets must have equal lengths");
+
+    PairInput input;
+    pair_stats_indices (path_edges, input.path_edges);
+    pair_stats_offsets (path_offsets, input.path_offsets);
+    pair_stats_indices (from, input.from);
+    pair_stats_indices (to, input.to);
+    pair_stats_indices (shared_edges, input.shared_edges);
+    pair_stats_offsets (shared_offsets, input.shared_offsets);
+
+    const size_t npaths = input.path_offsets.size () - 1;
+    for (size_t i = 0; i < input.from.size (); i++)
+        if (input.from [i] >= npaths || input.to [i] >= npaths)
+            cpp11::stop ("from and to must index paths");
+
+    // Highway codes are shifted to 0-based, with NA values as -1:
+    std::vector <int> hw (static_cast <size_t> (highway.size ()));
+    for (size_t i = 0; i < hw.size (); i++)
+    {
+        const int h = highway [static_cast <R_xlen_t> (i)];
+        hw [i] = h == NA_INTEGER || h < 1 || h > n_highway ? -1 : h - 1;
+    }
+
+    PairEdgeData edge_data;
+    edge_data.d = REAL (d);
+    edge_data.centrality = REAL (centrality);
+    edge_data.highway = hw.data ();
+    edge_data.n_highway = static_cast <size_t> (n_highway);
+
+    PairStats out;
+    pair_stats::pair_stats (edge_data, input, nthreads, out);
+
+    const R_xlen_t n = static_cast <R_xlen_t> (input.from.size ());
+    writable::doubles stats (static_cast <R_xlen_t> (out.stats.size ()));
+    for (size_t i = 0; i < out.stats.size (); i++)
+        stats [static_cast <R_xlen_t> (i)] = std::isnan (out.stats [i]) ?
+            NA_REAL : out.stats [i];
+
+    writable::integers hw_shared (n), hw_from (n), hw_to (n);
+    for (R_xlen_t i = 0; i < n; i++)
+    {
+        const size_t is = static_cast <size_t> (i);
+        hw_shared [i] = out.hw_shared [is] == INFINITE_INDEX ?
+            NA_INTEGER : static_cast <int> (out.hw_shared [is]) + 1;
+        hw_from [i] = out.hw_from [is] == INFINITE_INDEX ?
+            NA_INTEGER : static_cast <int> (out.hw_from [is]) + 1;
+        hw_to [i] = out.hw_to [is] == INFINITE_INDEX ?
+            NA_INTEGER : static_cast <int> (out.hw_to [is]) + 1;
+    }
+
+    writable::list res (4);
+    res [0] = stats;
+    res [1] = hw_shared;
+    res [2] = hw_from;
+    res [3] = hw_to;
+
+    return res;
+}
@@ -0,0 +1,183 @@
+#include "pair_stats.h"
+#include "threads.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Median, mean, and maximum of distance-weighted centrality values,
+// 'centr * d / sum (d)', ignoring NA centrality values. Values are NA where
+// there are no centrality values, or where any distances are NA. Both input
+// vectors are modified.
+void pair_stats::centrality_stats (std::vector <double> &centr,
+        std::vector <double> &d,
+        double *res)
+{
+    res [0] = res [1] = res [2] = NAN;
+
+    long double dsum = 0.0L;
+    for (auto di: d)
+        dsum += di;
+    if (std::isnan (static_cast <double> (dsum)))
+        return;
+
+    // Weighted values are collected in 'centr', with all NA values removed:
+    size_t n = 0;
+    for (size_t i = 0; i < centr.size (); i++)
+    {
+        const double cd = centr [i] * d [i] / static_cast <double> (dsum);
+        if (!std::isnan (cd))
+            centr [n++] = cd;
+    }
+    centr.resize (n);
+    if (n == 0)
+        return;
+
+    long double s = 0.0L;
+    double mx = centr [0];
+    for (auto c: centr)
+    {
+        s += c;
+        mx = std::max (mx, c);
+    }
+    res [1] = static_cast <double> (s / static_cast <long double> (n));
+    res [2] = mx;
+
+    // Median as the mean of the two central values where 'n' is even:
+    const size_t half = n / 2;
+    std::nth_element (centr.begin (),
+            centr.begin () + static_cast <std::ptrdiff_t> (half), centr.end ());
+    res [0] = centr [half];
+    if (n % 2 == 0)
+    {
+        const double lower = *std::max_element (centr.begin (),
+                centr.begin () + static_cast <std::ptrdiff_t> (half));
+        res [0] = (lower + res [0]) / 2.0;
+    }
+}
+
+// Most frequent highway code of 'edges', with ties resolved in favour of the
+// lowest code. 'counts' is working space of size 'n_highway'.
+index_t pair_stats::modal_highway (const PairEdgeData &edge_data,
+        const std::vector <index_t> &edges,
+        std::vector <index_t> &counts)
+{
+    std::fill (counts.begin (), counts.end (), 0);
+    for (auto e: edges)
+    {
+        if (e == INFINITE_INDEX || edge_data.highway [e] < 0)
+            continue;
+        counts [static_cast <size_t> (edge_data.highway [e])]++;
+    }
+
+    index_t mode = INFINITE_INDEX, max_count = 0;
+    for (size_t h = 0; h < counts.size (); h++)
+    {
+        if (counts [h] > max_count)
+        {
+            max_count = counts [h];
+            mode = static_cast <index_t> (h);
+        }
+    }
+
+    return mode;
+}
+
+// All numeric statistics and modal highway types for all pairs of
+// neighbourhoods, split between threads. The numeric statistics for each pair
+// are, in order: total distances along and off the shared boundary; and
+// (median, mean, max) of distance-weighted centrality along the shared
+// boundary, off the shared boundary, and on the non-shared edges of the "from"
+// and "to" paths. Membership of shared edges is tested by binary search of
+// the sorted shared edges of each pair.
+void pair_stats::pair_stats (const PairEdgeData &edge_data,
+        const PairInput &input,
+        const int nthreads,
+        PairStats &out)
+{
+    const size_t n = input.from.size ();
+    out.stats.resize (n * N_PAIR_STATS);
+    out.hw_shared.resize (n);
+    out.hw_from.resize (n);
+    out.hw_to.resize (n);
+
+    threads::parallel_for (n, nthreads,
+            [&] (size_t from, size_t to, size_t) {
+
+                std::vector <index_t> shared, edges_in, edges_out, edges_p;
+                std::vector <double> centr, d;
+                std::vector <index_t> counts (edge_data.n_highway);
+
+                // Copy (centrality, d) values of edges into working vectors:
+                auto fill_values = [&] (const std::vector <index_t> &edges) {
+                    centr.resize (edges.size ());
+                    d.resize (edges.size ());
+                    for (size_t j = 0; j < edges.size (); j++)
+                    {
+                        const index_t e = edges [j];
+                        centr [j] = e == INFINITE_INDEX ?
+                            NAN : edge_data.centrality [e];
+                        d [j] = e == INFINITE_INDEX ? NAN : edge_data.d [e];
+                    }
+                };
+                auto dist_sum = [&] (const std::vector <index_t> &edges) {
+                    long double s = 0.0L;
+                    for (auto e: edges)
+                        s += e == INFINITE_INDEX ? NAN : edge_data.d [e];
+                    return static_cast <double> (s);
+                };
+
+                for (size_t i = from; i < to; i++)
+                {
+                    shared.assign (input.shared_edges.begin () +
+                            input.shared_offsets [i],
+                            input.shared_edges.begin () +
+                            input.shared_offsets [i + 1]);
+                    std::sort (shared.begin (), shared.end ());
+
+                    double *res = out.stats.data () + i * N_PAIR_STATS;
+
+                    // Edges of each path on and off the shared boundary:
+                    edges_in.clear ();
+                    edges_out.clear ();
+                    const index_t paths [2] = {input.from [i], input.to [i]};
+                    for (size_t p = 0; p < 2; p++)
+                    {
+                        edges_p.clear ();
+                        for (index_t j = input.path_offsets [paths [p]];
+                                j < input.path_offsets [paths [p] + 1]; j++)
+                        {
+                            const index_t e = input.path_edges [j];
+                            if (e != INFINITE_INDEX &&
+                                    std::binary_search (shared.begin (),
+                                        shared.end (), e))
+                                edges_in.push_back (e);
+                            else
+                            {
+                                edges_out.push_back (e);
+                                edges_p.push_back (e);
+                            }
+                        }
+
+                        fill_values (edges_p);
+                        pair_stats::centrality_stats (centr, d,
+                                res + 8 + 3 * p);
+                        index_t hw = pair_stats::modal_highway (edge_data,
+                                edges_p, counts);
+                        if (p == 0)
+                            out.hw_from [i] = hw;
+                        else
+                            out.hw_to [i] = hw;
+                    }
+
+                    res [0] = dist_sum (edges_in);
+                    res [1] = dist_sum (edges_out);
+                    fill_values (edges_in);
+                    pair_stats::centrality_stats (centr, d, res + 2);
+                    fill_values (edges_out);
+                    pair_stats::centrality_stats (centr, d, res + 5);
+
+                    out.hw_shared [i] = pair_stats::modal_highway (edge_data,
+                            shared, counts);
+                }
+            });
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "typedefs.h"
+
+#include <vector>
+
+// Number of numeric statistics calculated for each pair of neighbourhoods.
+const size_t N_PAIR_STATS = 14;
+
+// Per-edge data of a network, with NA values as NaN for doubles, or negative
+// values for 0-based integer highway codes.
+struct PairEdgeData
+{
+    const double *d;
+    const double *centrality;
+    const int *highway;
+    size_t n_highway;
+};
+
+// Paths and shared edges of pairs, both in compressed sparse row form, with
+// edges of path 'i' in path_edges [path_offsets [i]:(path_offsets [i + 1] - 1)],
+// and shared edges of pair 'i' likewise indexed by 'shared_offsets'. Edges are
+// indices into 'PairEdgeData' vectors, or INFINITE_INDEX where unknown.
+struct PairInput
+{
+    std::vector <index_t> path_edges;
+    std::vector <index_t> path_offsets;
+    std::vector <index_t> from;
+    std::vector <index_t> to;
+    std::vector <index_t> shared_edges;
+    std::vector <index_t> shared_offsets;
+};
+
+// Numeric statistics of pair 'i' are in stats [(i * N_PAIR_STATS):...], and
+// modal highway codes are INFINITE_INDEX where there are no highway values.
+struct PairStats
+{
+    std::vector <double> stats;
+    std::vector <index_t> hw_shared;
+    std::vector <index_t> hw_from;
+    std::vector <index_t> hw_to;
+};
+
+namespace pair_stats {
+
+void centrality_stats (std::vector <double> &centr,
+        std::vector <double> &d,
+        double *res);
+
+index_t modal_highway (const PairEdgeData &edge_data,
+        const std::vector <index_t> &edges,
+        std::vector <index_t> &counts);
+
+void pair_stats (const PairEdgeData &edge_data,
+        const PairInput &input,
+        const int nthreads,
+        PairStats &out);
+
+} // end namespace pair_stats
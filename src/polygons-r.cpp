@@ -0,0 +1,81 @@
+#include "typedefs.h"
+#include "ingest.h"
+#include "polygons.h"
+#include "stats.h"
+
+#include "cpp11.hpp"
+
+using namespace cpp11;
+
+// Areas and perimeters of all paths, each of which is a data.frame of
+// consecutive edges with longitude and latitude coordinates. Polygons are
+// formed from all start vertices and the final end vertex of each path, and
+// are always closed. Return value is a list of two vectors of areas and
+// perimeters in metres.
+[[cpp11::register]]
+writable::list cpp_poly_areas(list paths, const std::string method)
+{
+    stats::PhaseTimer timer ("poly_areas");
+
+    AreaMethod m;
+    if (method == "mercator")
+        m = AreaMethod::MERCATOR;
+    else if (method == "scaled")
+        m = AreaMethod::SCALED;
+    else if (method == "ellipsoid")
+        m = AreaMethod::ELLIPSOID;
+    else
+        cpp11::stop ("method must be one of 'mercator', 'scaled', or 'ellipsoid'");
+
+    std::vector <double> lon, lat;
+    std::vector <index_t> offsets;
+    ingest::path_coords (paths, lon, lat, offsets);
+    const size_t n = offsets.size () - 1;
+
+    std::vector <double> area, perimeter;
+    polygons::areas (lon, lat, offsets, m, area, perimeter);
+
+    writable::doubles area_out (static_cast <R_xlen_t> (n));
+    writable::doubles perimeter_out (static_cast <R_xlen_t> (n));
+    for (size_t i = 0; i < n; i++)
+    {
+        area_out [static_cast <R_xlen_t> (i)] = area [i];
+        perimeter_out [static_cast <R_xlen_t> (i)] = perimeter [i];
+    }
+
+    writable::list res (2);
+    res [0] = area_out;
+    res [1] = perimeter_out;
+
+    return res;
+}
+
+// Area centroids of all paths, as for 'cpp_poly_areas', in spherical Mercator
+// coordinates. Return value is a list of x and y coordinates.
+[[cpp11::register]]
+writable::list cpp_poly_centroids(list paths)
+{
+    stats::PhaseTimer timer ("poly_centroids");
+
+    std::vector <double> lon, lat;
+    std::vector <index_t> offsets;
+    ingest::path_coords (paths, lon, lat, offsets);
+    const size_t n = offsets.size () - 1;
+
+    std::vector <double> x, y;
+    polygons::centroids (lon, lat, offsets, x, y);
+
+    writable::doubles x_out (static_cast <R_xlen_t> (n));
+    writable::doubles y_out (static_cast <R_xlen_t> (n));
+    for (size_t i = 0; i < n; i++)
+    {
+        x_out [static_cast <R_xlen_t> (i)] = x [i];
+        y_out [static_cast <R_xlen_t> (i)] = y [i];
+    }
+
+    writable::list res (2);
+    res [0] = x_out;
+    res [1] = y_out;
+
+    return res;
+}
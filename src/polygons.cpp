@@ -0,0 +1,252 @@
+#include "polygons.h"
+
+#include <cmath>
+
+const double PI = 3.14159265358979323846;
+const double DEG2RAD = PI / 180.0;
+
+// Spherical Web-Mercator projection of (lon, lat) in degrees.
+void polygons::to_mercator (const double lon, const double lat,
+        double &x, double &y)
+{
+    x = polygons::EARTH_RADIUS * lon * DEG2RAD;
+    y = polygons::EARTH_RADIUS * std::log (std::tan (PI / 4.0 +
+                lat * DEG2RAD / 2.0));
+}
+
+// The function 'q' of Snyder (1987) Eq. 3-12, for latitude with sine
+// 'sinphi', and ellipsoid eccentricity 'e'. The sine of authalic latitude is
+// q (phi) / q (pi / 2).
+double polygons::authalic_q (const double sinphi, const double e)
+{
+    const double esin = e * sinphi;
+    return (1.0 - e * e) * (sinphi / (1.0 - esin * esin) -
+            std::log ((1.0 - esin) / (1.0 + esin)) / (2.0 * e));
+}
+
+// Distance in metres between two points on the WGS84 ellipsoid, from
+// Vincenty's inverse formula. Nearly antipodal points, for which the formula
+// may not converge, fall back to great circle distances.
+double polygons::vincenty_dist (const double lon1, const double lat1,
+        const double lon2, const double lat2)
+{
+    const double a = polygons::EARTH_RADIUS;
+    const double f = polygons::WGS84_F;
+    const double b = a * (1.0 - f);
+
+    const double L = (lon2 - lon1) * DEG2RAD;
+    const double U1 = std::atan ((1.0 - f) * std::tan (lat1 * DEG2RAD));
+    const double U2 = std::atan ((1.0 - f) * std::tan (lat2 * DEG2RAD));
+    const double sinU1 = std::sin (U1), cosU1 = std::cos (U1);
+    const double sinU2 = std::sin (U2), cosU2 = std::cos (U2);
+
+    double lambda = L, lambda_prev;
+    double sin_sigma = 0.0, cos_sigma = 1.0, sigma = 0.0;
+    double cos2_alpha = 1.0, cos_2sigma_m = 0.0;
+    int iter = 0;
+    do
+    {
+        const double sin_lambda = std::sin (lambda);
+        const double cos_lambda = std::cos (lambda);
+        const double t1 = cosU2 * sin_lambda;
+        const double t2 = cosU1 * sinU2 - sinU1 * cosU2 * cos_lambda;
+        sin_sigma = std::sqrt (t1 * t1 + t2 * t2);
+        if (sin_sigma == 0.0)
+            return 0.0; // coincident points
+        cos_sigma = sinU1 * sinU2 + cosU1 * cosU2 * cos_lambda;
+        sigma = std::atan2 (sin_sigma, cos_sigma);
+        const double sin_alpha = cosU1 * cosU2 * sin_lambda / sin_sigma;
+        cos2_alpha = 1.0 - sin_alpha * sin_alpha;
+        cos_2sigma_m = cos2_alpha != 0.0 ?
+            cos_sigma - 2.0 * sinU1 * sinU2 / cos2_alpha : 0.0;
+        const double C = f / 16.0 * cos2_alpha * (4.0 + f * (4.0 - 3.0 * cos2_alpha));
+        lambda_prev = lambda;
+        lambda = L + (1.0 - C) * f * sin_alpha * (sigma + C * sin_sigma *
+                (cos_2sigma_m + C * cos_sigma *
+                 (-1.0 + 2.0 * cos_2sigma_m * cos_2sigma_m)));
+    } while (std::fabs (lambda - lambda_prev) > 1.0e-12 && ++iter < 100);
+
+    if (iter >= 100)
+    {
+        const double dlat = (lat2 - lat1) * DEG2RAD;
+        const double h = std::pow (std::sin (dlat / 2.0), 2.0) +
+            std::cos (lat1 * DEG2RAD) * std::cos (lat2 * DEG2RAD) *
+            std::pow (std::sin (L / 2.0), 2.0);
+        return 2.0 * a * std::asin (std::min (1.0, std::sqrt (h)));
+    }
+
+    const double u2 = cos2_alpha * (a * a - b * b) / (b * b);
+    const double A = 1.0 + u2 / 16384.0 * (4096.0 + u2 * (-768.0 + u2 *
+                (320.0 - 175.0 * u2)));
+    const double B = u2 / 1024.0 * (256.0 + u2 * (-128.0 + u2 *
+                (74.0 - 47.0 * u2)));
+    const double delta_sigma = B * sin_sigma * (cos_2sigma_m + B / 4.0 *
+            (cos_sigma * (-1.0 + 2.0 * cos_2sigma_m * cos_2sigma_m) -
+             B / 6.0 * cos_2sigma_m * (-3.0 + 4.0 * sin_sigma * sin_sigma) *
+             (-3.0 + 4.0 * cos_2sigma_m * cos_2sigma_m)));
+
+    return b * A * (sigma - delta_sigma);
+}
+
+// Area and perimeter of a single polygon of 'n' vertices, which is always
+// treated as closed, whether or not the final vertex equals the first.
+void polygons::one_polygon (const double *lon,
+        const double *lat,
+        const size_t n,
+        const AreaMethod method,
+        double &area,
+        double &perimeter)
+{
+    area = perimeter = 0.0;
+    if (n < 2)
+        return;
+
+    if (method == AreaMethod::ELLIPSOID)
+    {
+        // Area on authalic sphere, from sum of trapezoids between each edge
+        // and the equator:
+        const double f = polygons::WGS84_F;
+        const double e = std::sqrt (f * (2.0 - f));
+        const double qp = polygons::authalic_q (1.0, e);
+        const double rq2 = polygons::EARTH_RADIUS * polygons::EARTH_RADIUS *
+            qp / 2.0;
+
+        for (size_t i = 0; i < n; i++)
+        {
+            const size_t j = (i + 1) % n;
+            double dlon = (lon [j] - lon [i]) * DEG2RAD;
+            if (dlon > PI)
+                dlon -= 2.0 * PI;
+            else if (dlon < -PI)
+                dlon += 2.0 * PI;
+            const double sinb_i = polygons::authalic_q (
+                    std::sin (lat [i] * DEG2RAD), e) / qp;
+            const double sinb_j = polygons::authalic_q (
+                    std::sin (lat [j] * DEG2RAD), e) / qp;
+            area += dlon * (sinb_i + sinb_j);
+            perimeter += polygons::vincenty_dist (lon [i], lat [i],
+                    lon [j], lat [j]);
+        }
+        area = std::fabs (area) * rq2 / 2.0;
+
+        return;
+    }
+
+    // Coordinates are relative to the first vertex, to avoid loss of
+    // precision in cross products of large Mercator values:
+    double lat_mean = 0.0;
+    double x0, y0, x_i = 0.0, y_i = 0.0, x_j, y_j;
+    polygons::to_mercator (lon [0], lat [0], x0, y0);
+    for (size_t i = 0; i < n; i++)
+    {
+        const size_t j = (i + 1) % n;
+        polygons::to_mercator (lon [j], lat [j], x_j, y_j);
+        x_j -= x0;
+        y_j -= y0;
+
+        area += x_i * y_j - x_j * y_i;
+        double d = std::sqrt ((x_j - x_i) * (x_j - x_i) +
+                (y_j - y_i) * (y_j - y_i));
+        if (method == AreaMethod::SCALED)
+            d *= std::cos ((lat [i] + lat [j]) * DEG2RAD / 2.0);
+        perimeter += d;
+        lat_mean += lat [i];
+
+        x_i = x_j;
+        y_i = y_j;
+    }
+    area = std::fabs (area) / 2.0;
+
+    if (method == AreaMethod::SCALED)
+    {
+        // Mercator scales areas by sec^2 (lat):
+        const double c = std::cos (lat_mean / static_cast <double> (n) * DEG2RAD);
+        area *= c * c;
+    }
+}
+
+// Areas and perimeters of all polygons, with vertices of polygon 'i' in
+// lon [offsets [i]:(offsets [i + 1] - 1)] and equivalent 'lat' values.
+void polygons::areas (const std::vector <double> &lon,
+        const std::vector <double> &lat,
+        const std::vector <index_t> &offsets,
+        const AreaMethod method,
+        std::vector <double> &area,
+        std::vector <double> &perimeter)
+{
+    const size_t n = offsets.size () - 1;
+    area.resize (n);
+    perimeter.resize (n);
+    for (size_t i = 0; i < n; i++)
+    {
+        polygons::one_polygon (lon.data () + offsets [i],
+                lat.data () + offsets [i],
+                offsets [i + 1] - offsets [i],
+                method, area [i], perimeter [i]);
+    }
+}
+
+// Area centroid in spherical Mercator coordinates of a single polygon of 'n'
+// vertices. Degenerate polygons with no area have centroids at the mean of
+// their vertices.
+void polygons::centroid (const double *lon,
+        const double *lat,
+        const size_t n,
+        double &x,
+        double &y)
+{
+    x = y = 0.0;
+    if (n == 0)
+        return;
+
+    double x0, y0, x_i = 0.0, y_i = 0.0, x_j, y_j;
+    double area = 0.0, cx = 0.0, cy = 0.0, mx = 0.0, my = 0.0;
+    polygons::to_mercator (lon [0], lat [0], x0, y0);
+    for (size_t i = 0; i < n; i++)
+    {
+        const size_t j = (i + 1) % n;
+        polygons::to_mercator (lon [j], lat [j], x_j, y_j);
+        x_j -= x0;
+        y_j -= y0;
+
+        const double a = x_i * y_j - x_j * y_i;
+        area += a;
+        cx += (x_i + x_j) * a;
+        cy += (y_i + y_j) * a;
+        mx += x_i;
+        my += y_i;
+
+        x_i = x_j;
+        y_i = y_j;
+    }
+
+    if (area != 0.0)
+    {
+        x = x0 + cx / (3.0 * area);
+        y = y0 + cy / (3.0 * area);
+    } else
+    {
+        x = x0 + mx / static_cast <double> (n);
+        y = y0 + my / static_cast <double> (n);
+    }
+}
+
+// Centroids of all polygons, with vertices indexed by 'offsets' as for
+// 'areas'.
+void polygons::centroids (const std::vector <double> &lon,
+        const std::vector <double> &lat,
+        const std::vector <index_t> &offsets,
+        std::vector <double> &x,
+        std::vector <double> &y)
+{
+    const size_t n = offsets.size () - 1;
+    x.resize (n);
+    y.resize (n);
+    for (size_t i = 0; i < n; i++)
+    {
+        polygons::centroid (lon.data () + offsets [i],
+                lat.data () + offsets [i],
+                offsets [i + 1] - offsets [i],
+                x [i], y [i]);
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "typedefs.h"
+
+#include <vector>
+
+// Methods to calculate areas and perimeters of polygons in geographic
+// coordinates:
+// - MERCATOR: planar values in spherical Web-Mercator coordinates;
+// - SCALED: Mercator values scaled by the cosine of latitude, to approximate
+// true values;
+// - ELLIPSOID: values on the WGS84 ellipsoid, with areas from the authalic
+// sphere, and perimeters from Vincenty's inverse formula.
+enum class AreaMethod { MERCATOR, SCALED, ELLIPSOID };
+
+namespace polygons {
+
+// Semi-major axis of WGS84, which is also the radius of spherical Mercator:
+const double EARTH_RADIUS = 6378137.0;
+const double WGS84_F = 1.0 / 298.257223563;
+
+void to_mercator (const double lon, const double lat, double &x, double &y);
+
+double authalic_q (const double sinphi, const double e);
+
+double vincenty_dist (const double lon1, const double lat1,
+        const double lon2, const double lat2);
+
+void one_polygon (const double *lon,
+        const double *lat,
+        const size_t n,
+        const AreaMethod method,
+        double &area,
+        double &perimeter);
+
+void areas (const std::vector <double> &lon,
+        const std::vector <double> &lat,
+        const std::vector <index_t> &offsets,
+        const AreaMethod method,
+        std::vector <double> &area,
+        std::vector <double> &perimeter);
+
+void centroid (const double *lon,
+        const double *lat,
+        const size_t n,
+        double &x,
+        double &y);
+
+void centroids (const std::vector <double> &lon,
+        const std::vector <double> &lat,
+        const std::vector <index_t> &offsets,
+        std::vector <double> &x,
+        std::vector <double> &y);
+
+} // end namespace polygons
@@ -0,0 +1,49 @@
+#include "typedefs.h"
+#include "preprocess.h"
+#include "ingest.h"
+#include "stats.h"
+
+#include "cpp11.hpp"
+
+#include <algorithm> // count
+
+using namespace cpp11;
+
+// Return 1-based indices of all edges which remain after removing all
+// dangling trees from the network.
+[[cpp11::register]]
+writable::integers cpp_preprocess(list df)
+{
+    stats::PhaseTimer timer ("preprocess");
+
+    const SEXP n1 = ingest::string_column (df, ".vx0");
+    const SEXP n2 = ingest::string_column (df, ".vx1");
+    const size_t n = static_cast <size_t> (Rf_xlength (n1));
+
+    CharMap vert_map;
+    vert_map.reserve (n);
+    std::vector <SEXP> verts;
+    std::vector <index_t> v0, v1;
+    ingest::intern_chars (n1, vert_map, verts, v0);
+    ingest::intern_chars (n2, vert_map, verts, v1);
+
+    std::vector <bool> can_be_terminal (verts.size ());
+    for (size_t i = 0; i < verts.size (); i++)
+        can_be_terminal [i] = LENGTH (verts [i]) > 0;
+
+    std::vector <bool> keep (n, true);
+    preprocess::peel_terminal (v0, v1, can_be_terminal, keep);
+
+    const R_xlen_t nkeep = static_cast <R_xlen_t> (
+            std::count (keep.begin (), keep.end (), true));
+    writable::integers out (nkeep);
+
+    R_xlen_t count = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        if (keep [i])
+            out [count++] = static_cast <int> (i) + 1; // return 1-based R indexing
+    }
+
+    return out;
+}
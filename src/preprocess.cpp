@@ -1,144 +1,69 @@
 #include "preprocess.h"
 
-using namespace cpp11;
-namespace writable = cpp11::writable;
-
-const nodeset_t preprocess::get_terminal_nodes (
-        const std::vector <node_t> &n1,
-        const std::vector <node_t> &n2)
-{
-
-    nodeset_t terminal;
-    nodeset_t not_terminal;
-    terminal.reserve (n1.size ());
-    not_terminal.reserve (n1.size ());
-
-    // loop over both vectors separately to avoid copying
-    preprocess::get_one_terminal_nodes (
-            n1, terminal, not_terminal);
-    preprocess::get_one_terminal_nodes (
-            n2, terminal, not_terminal);
-
-    return terminal;
-}
-
-void preprocess::get_one_terminal_nodes (
-        const std::vector <node_t> &nodes,
-        nodeset_t &terminal,
-        nodeset_t &not_terminal)
+// Remove all dangling trees from the edges (v0, v1) flagged in 'keep', by
+// removing edges ending at terminal vertices of degree one, and then
+// continuing from the other vertices of those edges until no terminal vertices
+// remain. Only vertices flagged in 'can_be_terminal' are ever terminal. Each
+// vertex and edge is visited a constant number of times, so chains of any
+// length are removed in O(V + E) time.
+void preprocess::peel_terminal (const std::vector <index_t> &v0,
+        const std::vector <index_t> &v1,
+        const std::vector <bool> &can_be_terminal,
+        std::vector <bool> &keep)
 {
+    const size_t n = v0.size ();
+    const size_t nverts = can_be_terminal.size ();
 
-    for (node_t n: nodes)
+    std::vector <index_t> degree (nverts, 0L);
+    for (size_t i = 0; i < n; i++)
     {
-        if (n.length () < 1)
+        if (!keep [i])
             continue;
-        if (not_terminal.count (n) == 0)
-        {
-            if (terminal.count (n) == 0)
-            {
-                terminal.insert (n);
-            } else
-            {
-                terminal.erase (n);
-                not_terminal.insert (n);
-            }
-        }
+        degree [v0 [i]]++;
+        degree [v1 [i]]++;
     }
-}
-
-template <typename T1, typename T2>
-void utils::copy_column (
-        const list &df,
-        const std::string &col,
-        std::vector <T2> &result)
-{
-    T1 s = df [col];
-    result.resize (static_cast <size_t> (s.size ()));
-    std::copy (s.begin (), s.end (), result.begin ());
-}
-
-template <typename T>
-void utils::copy_vec (
-        const std::vector <T> &vfrom,
-        std::vector <T> &vto)
-{
-    vto.resize (vfrom.size ());
-    std::copy (vfrom.begin (), vfrom.end (), vto.begin ());
-}
-
-
-[[cpp11::register]]
-writable::integers cpp_preprocess(list df)
-{
 
-    std::vector <node_t> n1, n2;
-    utils::copy_column <strings, node_t> (df, ".vx0", n1);
-    utils::copy_column <strings, node_t> (df, ".vx1", n2);
-
-    std::vector <int> index (n1.size ());
-    std::iota (std::begin (index), std::end (index), 0);
-
-    nodeset_t terminal = preprocess::get_terminal_nodes (n1, n2);
-
-    nodeset_t terminal_all;
-    terminal_all.reserve (n1.size ());
-    for (auto t: terminal)
-        terminal_all.emplace (t);
-
-    int nloops = 0;
-    while (terminal.size () > 0)
+    // Edges incident to each vertex, in compressed sparse row form:
+    std::vector <index_t> offset (nverts + 1, 0L);
+    for (size_t v = 0; v < nverts; v++)
+        offset [v + 1] = offset [v] + degree [v];
+    std::vector <index_t> incident (offset.back ());
+    std::vector <index_t> pos (offset.begin (), offset.end () - 1);
+    for (index_t i = 0; i < n; i++)
     {
-        std::vector <int> index2;
-        std::vector <node_t> n1temp, n2temp;
-        index2.reserve (index.size ());
-        n1temp.reserve (index.size ());
-        n2temp.reserve (index.size ());
-
-        size_t count = 0;
-        for (size_t j = 0; j < index.size (); j++)
-        {
-            // https://github.com/r-lib/cpp11/issues/129#issuecomment-730415040
-            node_t n1_i = static_cast <node_t> (r_string (n1 [j]));
-            node_t n2_i = static_cast <node_t> (r_string (n2 [j]));
-
-            if (terminal.count (n1_i) == 0 &&
-                    terminal.count (n2_i) == 0)
-            {
-                index2.push_back (index [j]);
-                n1temp.push_back (n1_i);
-                n2temp.push_back (n2_i);
-                count++;
-            }
-        }
-        index2.resize (count);
-        n1temp.resize (count);
-        n2temp.resize (count);
-
-        terminal = preprocess::get_terminal_nodes (n1temp, n2temp);
-        for (auto t: terminal)
-            terminal_all.insert (t);
-
-        utils::copy_vec <int> (index2, index);
-        utils::copy_vec <node_t> (n1temp, n1);
-        utils::copy_vec <node_t> (n2temp, n2);
-
-        nloops++;
+        if (!keep [i])
+            continue;
+        incident [pos [v0 [i]]++] = i;
+        incident [pos [v1 [i]]++] = i;
     }
 
-    strings v0 = df [".vx0"];
-    strings v1 = df [".vx1"];
-
-    writable::integers out (v0.size () - static_cast <int> (terminal_all.size ()));
+    std::vector <index_t> queue;
+    for (index_t v = 0; v < nverts; v++)
+    {
+        if (degree [v] == 1L && can_be_terminal [v])
+            queue.push_back (v);
+    }
 
-    int count = 0;
-    for (int i = 0; i < v0.size (); i++)
+    while (!queue.empty ())
     {
-        if (terminal_all.find (v0 [i]) == terminal_all.end () &&
-                terminal_all.find (v1 [i]) == terminal_all.end ())
+        const index_t v = queue.back ();
+        queue.pop_back ();
+        if (degree [v] != 1L)
+            continue;
+
+        for (index_t k = offset [v]; k < offset [v + 1]; k++)
         {
-            out [count++] = i + 1; // return 1-based R indexing
+            const index_t i = incident [k];
+            if (!keep [i])
+                continue;
+
+            keep [i] = false;
+            degree [v0 [i]]--;
+            degree [v1 [i]]--;
+            const index_t w = v0 [i] == v ? v1 [i] : v0 [i];
+            if (degree [w] == 1L && can_be_terminal [w])
+                queue.push_back (w);
+            break;
         }
     }
-
-    return out;
 }
@@ -0,0 +1,111 @@
+#include "reduce_paths.h"
+#include "threads.h"
+
+#include <algorithm>
+
+// Sort and remove duplicates from each edge set, and convert all edges to
+// dense indices into the unique values of all sets. Returns the number of
+// unique values.
+size_t reduce_paths::sort_edge_sets (
+        std::vector <std::vector <int> > &edge_sets)
+{
+    std::vector <int> all_edges;
+    for (auto &e: edge_sets)
+    {
+        std::sort (e.begin (), e.end ());
+        e.erase (std::unique (e.begin (), e.end ()), e.end ());
+        all_edges.insert (all_edges.end (), e.begin (), e.end ());
+    }
+    std::sort (all_edges.begin (), all_edges.end ());
+    all_edges.erase (std::unique (all_edges.begin (), all_edges.end ()),
+            all_edges.end ());
+
+    for (auto &e: edge_sets)
+    {
+        for (auto &ei: e)
+        {
+            ei = static_cast <int> (std::lower_bound (all_edges.begin (),
+                        all_edges.end (), ei) - all_edges.begin ());
+        }
+    }
+
+    return all_edges.size ();
+}
+
+// Flag all edge sets which are supersets of any preceding edge set. Candidate
+// supersets of each set are taken from an inverted index of edges to the sets
+// which contain them, starting from the rarest edge of each set, so only a
+// few candidates need to be checked for each set.
+void reduce_paths::superset_paths (
+        const std::vector <std::vector <int> > &edge_sets_in,
+        std::vector <bool> &dupl_vec,
+        const int nthreads)
+{
+    const size_t n = edge_sets_in.size ();
+    dupl_vec.assign (n, false);
+    if (n < 2)
+        return;
+
+    std::vector <std::vector <int> > edge_sets (edge_sets_in);
+    const size_t n_edges = reduce_paths::sort_edge_sets (edge_sets);
+
+    // Inverted index in compressed sparse row form, with sets containing each
+    // edge in increasing order.
+    std::vector <size_t> offsets (n_edges + 1, 0L);
+    for (const auto &e: edge_sets)
+        for (auto ei: e)
+            offsets [static_cast <size_t> (ei) + 1]++;
+    for (size_t i = 0; i < n_edges; i++)
+        offsets [i + 1] += offsets [i];
+    std::vector <size_t> pos (offsets.begin (), offsets.end () - 1);
+    std::vector <index_t> set_index (offsets.back ());
+    for (size_t i = 0; i < n; i++)
+        for (auto ei: edge_sets [i])
+            set_index [pos [static_cast <size_t> (ei)]++] =
+                static_cast <index_t> (i);
+
+    std::vector <std::vector <index_t> > dupl_thread (
+            threads::n_threads (nthreads, n));
+
+    threads::parallel_for (n, nthreads,
+            [&] (size_t from, size_t to, size_t thread_id) {
+                std::vector <index_t> &dupl = dupl_thread [thread_id];
+                for (size_t i = from; i < to; i++)
+                {
+                    const std::vector <int> &set_i = edge_sets [i];
+                    if (set_i.empty ())
+                    {
+                        for (size_t j = i + 1; j < n; j++)
+                            dupl.push_back (static_cast <index_t> (j));
+                        continue;
+                    }
+
+                    size_t rarest = static_cast <size_t> (set_i [0]);
+                    for (auto ei: set_i)
+                    {
+                        const size_t e = static_cast <size_t> (ei);
+                        if ((offsets [e + 1] - offsets [e]) <
+                                (offsets [rarest + 1] - offsets [rarest]))
+                            rarest = e;
+                    }
+
+                    auto first = set_index.begin () +
+                        static_cast <long> (offsets [rarest]);
+                    auto last = set_index.begin () +
+                        static_cast <long> (offsets [rarest + 1]);
+                    first = std::upper_bound (first, last,
+                            static_cast <index_t> (i));
+                    for (auto j = first; j != last; ++j)
+                    {
+                        const std::vector <int> &set_j = edge_sets [*j];
+                        if (std::includes (set_j.begin (), set_j.end (),
+                                    set_i.begin (), set_i.end ()))
+                            dupl.push_back (*j);
+                    }
+                }
+            });
+
+    for (const auto &d: dupl_thread)
+        for (auto j: d)
+            dupl_vec [j] = true;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "typedefs.h"
+
+#include <vector>
+
+namespace reduce_paths {
+
+size_t sort_edge_sets (std::vector <std::vector <int> > &edge_sets);
+
+void superset_paths (const std::vector <std::vector <int> > &edge_sets,
+        std::vector <bool> &dupl_vec,
+        const int nthreads);
+
+} // end namespace reduce_paths
@@ -0,0 +1,133 @@
+#include "scoring.h"
+#include "threads.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Position of the edge closest to the mid-point of the cumulative distance
+// along 'n' edges, with the first of any ties. Distances which are NA are
+// taken as zero.
+index_t scoring::cut_point (const double *d,
+        const index_t *edges,
+        const size_t n)
+{
+    double total = 0.0;
+    for (size_t i = 0; i < n; i++)
+        total += std::isnan (d [edges [i]]) ? 0.0 : d [edges [i]];
+
+    index_t pos = 0;
+    double cumsum = 0.0, best = INFINITY;
+    for (size_t i = 0; i < n; i++)
+    {
+        cumsum += std::isnan (d [edges [i]]) ? 0.0 : d [edges [i]];
+        const double diff = std::fabs (cumsum - total / 2.0);
+        if (diff < best)
+        {
+            best = diff;
+            pos = static_cast <index_t> (i);
+        }
+    }
+
+    return pos;
+}
+
+// The cut edge, and all edges in the reverse direction between the same
+// vertices.
+void scoring::cut_edge_set (const CentralityGraph &graph,
+        const index_t cut,
+        std::vector <index_t> &cut_edges)
+{
+    cut_edges.clear ();
+    cut_edges.push_back (cut);
+    const index_t v0 = graph.from [cut], v1 = graph.to [cut];
+    for (index_t j = graph.out_offset [v1]; j < graph.out_offset [v1 + 1]; j++)
+        if (graph.to [graph.out_edges [j]] == v0)
+            cut_edges.push_back (graph.out_edges [j]);
+}
+
+// Score candidate 'i' by cutting the edge at the mid-point of the shared
+// boundary, as for the R function 'compare_centrality_native'. Changes in
+// centrality are calculated in the calling thread only.
+void scoring::score_cut (const CentralityEngine &engine,
+        const double *d,
+        const CutCandidates &candidates,
+        const size_t i,
+        CutScores &scores)
+{
+    scores.decr_in [i] = scores.incr_out [i] = NAN;
+    scores.cut_edge [i] = INFINITE_INDEX;
+
+    const index_t *in_edges = candidates.in_edges.data () +
+        candidates.in_offsets [i];
+    const size_t n_in = candidates.in_offsets [i + 1] - candidates.in_offsets [i];
+    if (n_in == 0)
+        return;
+
+    const index_t cut = in_edges [scoring::cut_point (d, in_edges, n_in)];
+    scores.cut_edge [i] = cut;
+    std::vector <index_t> cut_edges;
+    scoring::cut_edge_set (engine.graph, cut, cut_edges);
+    auto is_cut = [&] (const index_t e) {
+        return std::find (cut_edges.begin (), cut_edges.end (), e) !=
+            cut_edges.end ();
+    };
+
+    std::vector <double> delta;
+    size_t n_affected;
+    centrality::delta (engine, cut_edges, 1, delta, n_affected);
+    const std::vector <double> &full = engine.betweenness;
+
+    double sum_full = 0.0, sum_cut = 0.0;
+    size_t n_cut = 0;
+    for (size_t j = 0; j < n_in; j++)
+    {
+        const index_t e = in_edges [j];
+        sum_full += full [e];
+        if (!is_cut (e))
+        {
+            sum_cut += full [e] + delta [e];
+            n_cut++;
+        }
+    }
+    scores.decr_in [i] = 1.0 - (sum_cut / static_cast <double> (n_cut)) /
+        (sum_full / static_cast <double> (n_in));
+
+    // Ratios of cut to full centrality off the boundary, excluding edges
+    // with zero centrality in the full network:
+    double sum_ratio = 0.0;
+    size_t n_ratio = 0;
+    for (index_t j = candidates.out_offsets [i];
+            j < candidates.out_offsets [i + 1]; j++)
+    {
+        const index_t e = candidates.out_edges [j];
+        if (is_cut (e) || full [e] == 0.0)
+            continue;
+        sum_ratio += (full [e] + delta [e]) / full [e];
+        n_ratio++;
+    }
+    scores.incr_out [i] = sum_ratio / static_cast <double> (n_ratio) - 1.0;
+}
+
+// Score all candidates on a work-stealing pool of threads, as costs of each
+// candidate vary greatly with the density of the network around the cut.
+// Each candidate is scored in a single thread, and betweenness of the engine
+// is summed in blocks which do not depend on the number of threads, so
+// results are identical for any number of threads. 'progress' is called from
+// the calling thread only.
+void scoring::score_batch (const CentralityEngine &engine,
+        const double *d,
+        const CutCandidates &candidates,
+        const int nthreads,
+        const std::function <void (size_t)> &progress,
+        CutScores &scores)
+{
+    const size_t n = candidates.in_offsets.size () - 1;
+    scores.decr_in.resize (n);
+    scores.incr_out.resize (n);
+    scores.cut_edge.resize (n);
+
+    threads::parallel_steal (n, nthreads,
+            [&] (size_t i, size_t) {
+                scoring::score_cut (engine, d, candidates, i, scores);
+            }, progress);
+}
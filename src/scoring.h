@@ -0,0 +1,53 @@
+#pragma once
+
+#include "typedefs.h"
+#include "centrality.h"
+
+#include <functional>
+#include <vector>
+
+// Candidate cuts of pairs of neighbourhoods, with network indices of edges
+// of candidate 'i' along the shared boundary in
+// in_edges [in_offsets [i]:(in_offsets [i + 1] - 1)], and edges of both
+// neighbourhoods off the boundary likewise in 'out_edges'.
+struct CutCandidates
+{
+    std::vector <index_t> in_edges;
+    std::vector <index_t> in_offsets;
+    std::vector <index_t> out_edges;
+    std::vector <index_t> out_offsets;
+};
+
+// Relative decrease in mean centrality along, and increase around, each cut
+// boundary, and the edge which was cut.
+struct CutScores
+{
+    std::vector <double> decr_in;
+    std::vector <double> incr_out;
+    std::vector <index_t> cut_edge;
+};
+
+namespace scoring {
+
+index_t cut_point (const double *d,
+        const index_t *edges,
+        const size_t n);
+
+void cut_edge_set (const CentralityGraph &graph,
+        const index_t cut,
+        std::vector <index_t> &cut_edges);
+
+void score_cut (const CentralityEngine &engine,
+        const double *d,
+        const CutCandidates &candidates,
+        const size_t i,
+        CutScores &scores);
+
+void score_batch (const CentralityEngine &engine,
+        const double *d,
+        const CutCandidates &candidates,
+        const int nthreads,
+        const std::function <void (size_t)> &progress,
+        CutScores &scores);
+
+} // end namespace scoring
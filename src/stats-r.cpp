@@ -0,0 +1,50 @@
+#include "stats.h"
+
+#include "cpp11.hpp"
+
+using namespace cpp11;
+
+// Current values of all native work counters and phase timings, optionally
+// resetting them all to zero. Return value is a list of a named vector of
+// counters, and a list of phase names, numbers of calls, and total seconds.
+[[cpp11::register]]
+writable::list cpp_stats(const bool reset)
+{
+    writable::doubles counters_out (static_cast <R_xlen_t> (stats::N_COUNTERS));
+    writable::strings counter_names (static_cast <R_xlen_t> (stats::N_COUNTERS));
+    for (size_t i = 0; i < stats::N_COUNTERS; i++)
+    {
+        counters_out [static_cast <R_xlen_t> (i)] = static_cast <double> (
+                stats::counters [i].load (std::memory_order_relaxed));
+        counter_names [static_cast <R_xlen_t> (i)] = stats::counter_names [i];
+    }
+    counters_out.names () = counter_names;
+
+    std::vector <stats::Phase> phases;
+    {
+        std::lock_guard <std::mutex> lock (stats::phase_mutex);
+        phases = stats::phases;
+    }
+
+    const R_xlen_t n = static_cast <R_xlen_t> (phases.size ());
+    writable::strings phase_out (n);
+    writable::doubles calls_out (n), seconds_out (n);
+    for (R_xlen_t i = 0; i < n; i++)
+    {
+        const stats::Phase &p = phases [static_cast <size_t> (i)];
+        phase_out [i] = p.name;
+        calls_out [i] = static_cast <double> (p.calls);
+        seconds_out [i] = p.seconds;
+    }
+
+    if (reset)
+        stats::reset ();
+
+    writable::list res (4);
+    res [0] = counters_out;
+    res [1] = phase_out;
+    res [2] = calls_out;
+    res [3] = seconds_out;
+
+    return res;
+}
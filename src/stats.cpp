@@ -0,0 +1,53 @@
+#include "stats.h"
+
+#include <algorithm> // find_if
+
+const char *stats::counter_names [stats::N_COUNTERS] = {
+    "edges_visited",
+    "traces",
+    "trace_restarts",
+    "cycles_inserted",
+    "cycles_duplicate",
+    "key_collisions",
+    "cycle_set_max",
+    "superset_paths",
+    "tile_leftovers"
+};
+
+std::atomic <std::uint64_t> stats::counters [stats::N_COUNTERS] {};
+
+std::mutex stats::phase_mutex;
+std::vector <stats::Phase> stats::phases;
+
+// Increase a counter to 'n' if it is currently smaller.
+void stats::set_max (const Counter counter, const std::uint64_t n)
+{
+    std::uint64_t current = stats::counters [counter].load (
+            std::memory_order_relaxed);
+    while (current < n && !stats::counters [counter].compare_exchange_weak (
+                current, n, std::memory_order_relaxed)) {}
+}
+
+// Phases are retained in the order in which they are first called.
+void stats::add_time (const std::string &phase, const double seconds)
+{
+    std::lock_guard <std::mutex> lock (stats::phase_mutex);
+    auto it = std::find_if (stats::phases.begin (), stats::phases.end (),
+            [&phase] (const stats::Phase &p) { return p.name == phase; });
+    if (it == stats::phases.end ())
+    {
+        stats::phases.push_back (stats::Phase {phase, 1, seconds});
+        return;
+    }
+    it->calls++;
+    it->seconds += seconds;
+}
+
+void stats::reset ()
+{
+    for (size_t i = 0; i < stats::N_COUNTERS; i++)
+        stats::counters [i].store (0, std::memory_order_relaxed);
+
+    std::lock_guard <std::mutex> lock (stats::phase_mutex);
+    stats::phases.clear ();
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Counters of work done by native routines, accumulated over all calls in a
+// session until reset. Counters may be incremented from any thread, but are
+// generally accumulated locally and added once per batch of work.
+namespace stats {
+
+enum Counter
+{
+    EDGES_VISITED = 0, // edges added to traced paths
+    TRACES, // traces started from a start edge
+    TRACE_RESTARTS, // traces which ended without forming a cycle
+    CYCLES_INSERTED, // distinct cycles added to cycle sets
+    CYCLES_DUPLICATE, // cycles rejected as duplicates of existing cycles
+    KEY_COLLISIONS, // distinct cycles with equal keys
+    CYCLE_SET_MAX, // largest number of cycles held in any one cycle set
+    SUPERSET_PATHS, // paths removed as supersets of smaller paths
+    TILE_LEFTOVERS, // face traces which escaped their tiles
+    N_COUNTERS
+};
+
+extern const char *counter_names [N_COUNTERS];
+
+extern std::atomic <std::uint64_t> counters [N_COUNTERS];
+
+// Accumulated wall time of all calls to each named phase:
+struct Phase
+{
+    std::string name;
+    std::uint64_t calls;
+    double seconds;
+};
+
+extern std::mutex phase_mutex;
+extern std::vector <Phase> phases;
+
+inline void add (const Counter counter, const std::uint64_t n)
+{
+    counters [counter].fetch_add (n, std::memory_order_relaxed);
+}
+
+void set_max (const Counter counter, const std::uint64_t n);
+
+void add_time (const std::string &phase, const double seconds);
+
+void reset ();
+
+// Add the wall time from construction to destruction to a phase.
+class PhaseTimer
+{
+    public:
+
+        explicit PhaseTimer (const std::string &phase) :
+            name (phase), start (std::chrono::steady_clock::now ()) {}
+
+        ~PhaseTimer () {
+            const std::chrono::duration <double> dt =
+                std::chrono::steady_clock::now () - start;
+            stats::add_time (name, dt.count ());
+        }
+
+    private:
+
+        const std::string name;
+        const std::chrono::steady_clock::time_point start;
+};
+
+} // end namespace stats
@@ -0,0 +1,218 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace threads {
+
+// Number of threads to use for 'n' items of work, bounded by the available
+// hardware concurrency. Values of 'nthreads' < 1 use all available threads.
+inline size_t n_threads (const int nthreads, const size_t n)
+{
+    size_t nt = static_cast <size_t> (std::thread::hardware_concurrency ());
+    if (nt == 0)
+        nt = 1;
+    if (nthreads > 0)
+        nt = std::min (nt, static_cast <size_t> (nthreads));
+
+    return std::max (static_cast <size_t> (1), std::min (nt, n));
+}
+
+// Split the range [0, n) into contiguous chunks, one for each thread, and
+// call 'f (from, to, thread_id)' on each. Chunks are always the same for the
+// same number of threads, and 'f' must not call the R API. The first exception
+// thrown by 'f' is rethrown on the calling thread once all threads have joined.
+template <typename F>
+void parallel_for (const size_t n, const int nthreads, F f)
+{
+    const size_t nt = threads::n_threads (nthreads, n);
+    if (nt <= 1)
+    {
+        f (static_cast <size_t> (0), n, static_cast <size_t> (0));
+        return;
+    }
+
+    std::exception_ptr error;
+    std::mutex error_lock;
+    auto worker = [&] (const size_t from, const size_t to, const size_t tid) {
+        try
+        {
+            f (from, to, tid);
+        } catch (...)
+        {
+            std::lock_guard <std::mutex> guard (error_lock);
+            if (!error)
+                error = std::current_exception ();
+        }
+    };
+
+    const size_t chunk = (n + nt - 1) / nt;
+    std::vector <std::thread> pool;
+    pool.reserve (nt);
+    for (size_t t = 0; t < nt; t++)
+    {
+        const size_t from = t * chunk;
+        const size_t to = std::min (n, from + chunk);
+        if (from >= to)
+            break;
+        pool.emplace_back (worker, from, to, t);
+    }
+    for (auto &t: pool)
+        t.join ();
+
+    if (error)
+        std::rethrow_exception (error);
+}
+
+// Range of tasks [begin, end) still to be done by one thread, which may be
+// shared with other threads.
+struct TaskRange
+{
+    std::mutex lock;
+    size_t begin = 0, end = 0;
+};
+
+// Take the back half of the largest range of tasks of any other thread, or
+// return false if there are no tasks left.
+inline bool steal_tasks (std::vector <TaskRange> &ranges, const size_t thief)
+{
+    while (true)
+    {
+        size_t victim = thief, most = 0;
+        for (size_t t = 0; t < ranges.size (); t++)
+        {
+            if (t == thief)
+                continue;
+            std::lock_guard <std::mutex> guard (ranges [t].lock);
+            if (ranges [t].end - ranges [t].begin > most)
+            {
+                most = ranges [t].end - ranges [t].begin;
+                victim = t;
+            }
+        }
+        if (most == 0)
+            return false;
+
+        size_t begin, end;
+        {
+            std::lock_guard <std::mutex> guard (ranges [victim].lock);
+            const size_t remaining = ranges [victim].end - ranges [victim].begin;
+            if (remaining == 0)
+                continue; // victim has since finished; look again
+            begin = ranges [victim].begin + remaining / 2;
+            end = ranges [victim].end;
+            ranges [victim].end = begin;
+        }
+        std::lock_guard <std::mutex> guard (ranges [thief].lock);
+        ranges [thief].begin = begin;
+        ranges [thief].end = end;
+        return true;
+    }
+}
+
+// Run 'f (i, thread_id)' for each task 'i' in [0, n), where tasks may have
+// very different costs. Each thread starts with a contiguous range of tasks,
+// and threads which finish their own range steal half of the largest
+// remaining range of another thread. 'progress (n_done)' is called
+// periodically, and once all tasks are done, from the calling thread only, so
+// may call the R API, while 'f' must not. If 'f' throws, all threads stop
+// taking new tasks, and the first exception is rethrown on the calling thread
+// once all threads have joined.
+template <typename F, typename P>
+void parallel_steal (const size_t n, const int nthreads, F f, P progress)
+{
+    const size_t nt = threads::n_threads (nthreads, n);
+    if (nt <= 1)
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            f (i, static_cast <size_t> (0));
+            progress (i + 1);
+        }
+        return;
+    }
+
+    std::vector <TaskRange> ranges (nt);
+    const size_t chunk = (n + nt - 1) / nt;
+    for (size_t t = 0; t < nt; t++)
+    {
+        ranges [t].begin = std::min (n, t * chunk);
+        ranges [t].end = std::min (n, (t + 1) * chunk);
+    }
+
+    std::atomic <size_t> n_done (0);
+    std::atomic <bool> failed (false);
+    std::exception_ptr error;
+    std::mutex done_lock;
+    std::condition_variable done_cv;
+
+    auto worker = [&] (const size_t tid) {
+        while (!failed)
+        {
+            size_t i = 0;
+            bool have_task = false;
+            {
+                std::lock_guard <std::mutex> guard (ranges [tid].lock);
+                if (ranges [tid].begin < ranges [tid].end)
+                {
+                    i = ranges [tid].begin++;
+                    have_task = true;
+                }
+            }
+            if (!have_task)
+            {
+                if (!threads::steal_tasks (ranges, tid))
+                    break;
+                continue;
+            }
+
+            try
+            {
+                f (i, tid);
+            } catch (...)
+            {
+                std::lock_guard <std::mutex> guard (done_lock);
+                if (!error)
+                    error = std::current_exception ();
+                failed = true;
+                done_cv.notify_one ();
+                break;
+            }
+            if (++n_done == n)
+            {
+                std::lock_guard <std::mutex> guard (done_lock);
+                done_cv.notify_one ();
+            }
+        }
+    };
+
+    std::vector <std::thread> pool;
+    pool.reserve (nt);
+    for (size_t t = 0; t < nt; t++)
+        pool.emplace_back (worker, t);
+
+    std::unique_lock <std::mutex> guard (done_lock);
+    while (n_done < n && !failed)
+    {
+        done_cv.wait_for (guard, std::chrono::milliseconds (200));
+        if (!failed)
+            progress (n_done.load ());
+    }
+    guard.unlock ();
+
+    for (auto &t: pool)
+        t.join ();
+
+    if (error)
+        std::rethrow_exception (error);
+
+    progress (n);
+}
+
+} // end namespace threads
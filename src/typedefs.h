@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <limits>
 #include <string>
 #include <vector>
@@ -8,6 +9,10 @@
 
 const int INFINITE_INT = std::numeric_limits <int>::max ();
 
+// Dense integer IDs for interned vertices and edges:
+typedef std::uint32_t index_t;
+const index_t INFINITE_INDEX = std::numeric_limits <index_t>::max ();
+
 typedef std::string node_t;
 
 typedef std::unordered_map <node_t, int> nodemap_t;
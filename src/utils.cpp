@@ -1,13 +1,41 @@
 #include "utils.h"
 
-void utils::cut_terminal_rev (std::string &s)
+// Remove any terminal "_rev" suffix from an edge ID.
+CharView utils::cut_terminal_rev (const CharView &v)
 {
-    const std::string revend = "_rev";
+    CharView res = v;
+    if (v.len >= 4 && std::memcmp (v.s + v.len - 4, "_rev", 4) == 0)
+        res.len -= 4;
+    return res;
+}
+
+// 64-bit FNV-1a hash of character data, starting from a seed, followed by the
+// splitmix64 finaliser to spread all bits. Hashes with different seeds are
+// different functions of the same FNV state, but are not independent, so
+// wider hashes combined from them can still collide, and must be confirmed by
+// exact comparison.
+std::uint64_t utils::hash_chars (const char *s, const size_t len,
+        const std::uint64_t seed)
+{
+    std::uint64_t h = 0xcbf29ce484222325ULL ^ seed;
+    for (size_t i = 0; i < len; i++)
+    {
+        h ^= static_cast <unsigned char> (s [i]);
+        h *= 0x100000001b3ULL;
+    }
+
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebULL;
+    h ^= h >> 31;
 
-    const size_t n = s.length ();
-    const std::string send = s.substr (n - 4, n - 1);
-    if (std::strcmp (send.c_str (), revend.c_str ()) == 0)
-        s = s.substr (0, n - 4);
+    return h;
+}
+
+size_t CharViewHash::operator() (const CharView &v) const
+{
+    return static_cast <size_t> (utils::hash_chars (v.s, v.len, 0L));
 }
 
 // https://stackoverflow.com/questions/1577475/c-sorting-and-keeping-track-of-indexes
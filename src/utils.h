@@ -5,9 +5,33 @@
 #include <algorithm> // sort
 #include <numeric> // iota
 
+// View of character data held elsewhere, generally in R's global string
+// cache, so that string IDs can be hashed and compared without copying.
+struct CharView
+{
+    const char *s;
+    size_t len;
+
+    bool operator== (const CharView &v) const {
+        return len == v.len && std::memcmp (s, v.s, len) == 0;
+    }
+    bool operator< (const CharView &v) const {
+        const int cmp = std::memcmp (s, v.s, std::min (len, v.len));
+        return cmp < 0 || (cmp == 0 && len < v.len);
+    }
+};
+
+struct CharViewHash {
+
+    size_t operator() (const CharView &v) const;
+};
+
 namespace utils {
 
-void cut_terminal_rev (std::string &s);
+CharView cut_terminal_rev (const CharView &v);
+
+std::uint64_t hash_chars (const char *s, const size_t len,
+        const std::uint64_t seed);
 
 template <typename T>
 std::vector<size_t> sort_indexes(const std::vector<T> &v);
@@ -0,0 +1,60 @@
+#include "typedefs.h"
+#include "ingest.h"
+#include "zonal.h"
+#include "stats.h"
+
+#include "cpp11.hpp"
+
+using namespace cpp11;
+
+// Zonal statistics of raster 'values' within each path, where paths are as
+// for 'cpp_poly_areas'. 'values' is a numeric matrix with 'nrow' rows from
+// north to south, and 'grid' holds (xmin, ymax, dx, dy) of the raster in
+// degrees. Return value is a list of mean values, sums of values multiplied
+// by cell areas in square kilometres, and numbers of cells in each polygon.
+[[cpp11::register]]
+writable::list cpp_zonal_stats(list paths, doubles values, const int nrow,
+        doubles grid, const int nthreads)
+{
+    stats::PhaseTimer timer ("zonal_stats");
+
+    if (grid.size () != 4)
+        cpp11::stop ("grid must have four values of (xmin, ymax, dx, dy)");
+    if (nrow < 1 || values.size () % nrow != 0)
+        cpp11::stop ("values must be a matrix with nrow rows");
+
+    RasterGrid rg;
+    rg.values = REAL (values);
+    rg.nrow = static_cast <size_t> (nrow);
+    rg.ncol = static_cast <size_t> (values.size ()) / rg.nrow;
+    rg.xmin = grid [0];
+    rg.ymax = grid [1];
+    rg.dx = grid [2];
+    rg.dy = grid [3];
+
+    std::vector <double> lon, lat;
+    std::vector <index_t> offsets;
+    ingest::path_coords (paths, lon, lat, offsets);
+    const size_t n = offsets.size () - 1;
+
+    ZonalStats stats;
+    zonal::polygon_stats (rg, lon, lat, offsets, nthreads, stats);
+
+    writable::doubles mean_out (static_cast <R_xlen_t> (n));
+    writable::doubles sum_out (static_cast <R_xlen_t> (n));
+    writable::integers count_out (static_cast <R_xlen_t> (n));
+    for (size_t i = 0; i < n; i++)
+    {
+        const R_xlen_t ir = static_cast <R_xlen_t> (i);
+        mean_out [ir] = stats.count [i] > 0 ? stats.mean [i] : NA_REAL;
+        sum_out [ir] = stats.area_sum [i];
+        count_out [ir] = static_cast <int> (stats.count [i]);
+    }
+
+    writable::list res (3);
+    res [0] = mean_out;
+    res [1] = sum_out;
+    res [2] = count_out;
+
+    return res;
+}
@@ -0,0 +1,129 @@
+#include "zonal.h"
+#include "polygons.h"
+#include "threads.h"
+
+#include <algorithm>
+#include <cmath>
+
+const double ZONAL_DEG2RAD = 3.14159265358979323846 / 180.0;
+
+// Scanline rasterization of one closed polygon of 'n' vertices. Each raster
+// row is intersected with the polygon in spherical Mercator coordinates, in
+// which polygon edges are straight lines, and all cells with centres between
+// pairs of crossings are included. Cells with NaN values are skipped.
+void zonal::scan_polygon (const RasterGrid &grid,
+        const double *lon,
+        const double *lat,
+        const size_t n,
+        std::vector <double> &crossings,
+        double &sum,
+        double &area_sum,
+        index_t &count)
+{
+    sum = area_sum = 0.0;
+    count = 0;
+    if (n < 3)
+        return;
+
+    double lat_min = lat [0], lat_max = lat [0];
+    for (size_t i = 1; i < n; i++)
+    {
+        lat_min = std::min (lat_min, lat [i]);
+        lat_max = std::max (lat_max, lat [i]);
+    }
+
+    // Rows with centres in [lat_min, lat_max]:
+    const double r0 = std::ceil ((grid.ymax - lat_max) / grid.dy - 0.5);
+    const double r1 = std::floor ((grid.ymax - lat_min) / grid.dy - 0.5);
+    if (r1 < 0.0 || r0 >= static_cast <double> (grid.nrow))
+        return;
+    const size_t row0 = static_cast <size_t> (std::max (r0, 0.0));
+    const size_t row1 = static_cast <size_t> (std::min (r1,
+                static_cast <double> (grid.nrow) - 1.0));
+
+    // Mercator y-values of all vertices; x-values are linear in longitude,
+    // so crossings can be calculated directly in longitude:
+    std::vector <double> ym (n);
+    double xtemp;
+    for (size_t i = 0; i < n; i++)
+        polygons::to_mercator (lon [i], lat [i], xtemp, ym [i]);
+
+    const double dx_km = polygons::EARTH_RADIUS * grid.dx * ZONAL_DEG2RAD / 1000.0;
+
+    for (size_t r = row0; r <= row1; r++)
+    {
+        const double lat_r = grid.ymax - (static_cast <double> (r) + 0.5) * grid.dy;
+        double y;
+        polygons::to_mercator (0.0, lat_r, xtemp, y);
+
+        crossings.clear ();
+        for (size_t i = 0; i < n; i++)
+        {
+            const size_t j = (i + 1) % n;
+            if ((ym [i] > y) != (ym [j] > y))
+                crossings.push_back (lon [i] + (y - ym [i]) *
+                        (lon [j] - lon [i]) / (ym [j] - ym [i]));
+        }
+        std::sort (crossings.begin (), crossings.end ());
+
+        // True area of cells in this row, in square kilometres:
+        const double lat_top = (lat_r + grid.dy / 2.0) * ZONAL_DEG2RAD;
+        const double lat_bot = (lat_r - grid.dy / 2.0) * ZONAL_DEG2RAD;
+        const double cell_area = dx_km * polygons::EARTH_RADIUS / 1000.0 *
+            (std::sin (lat_top) - std::sin (lat_bot));
+
+        for (size_t k = 0; k + 1 < crossings.size (); k += 2)
+        {
+            // Columns with centres in [crossings [k], crossings [k + 1]):
+            const double c0 = std::ceil ((crossings [k] - grid.xmin) / grid.dx - 0.5);
+            const double c1 = std::ceil ((crossings [k + 1] - grid.xmin) / grid.dx - 0.5) - 1.0;
+            if (c1 < 0.0 || c0 >= static_cast <double> (grid.ncol))
+                continue;
+            const size_t col0 = static_cast <size_t> (std::max (c0, 0.0));
+            const size_t col1 = static_cast <size_t> (std::min (c1,
+                        static_cast <double> (grid.ncol) - 1.0));
+            for (size_t c = col0; c <= col1; c++)
+            {
+                const double v = grid.values [c * grid.nrow + r];
+                if (std::isnan (v))
+                    continue;
+                sum += v;
+                area_sum += v * cell_area;
+                count++;
+            }
+        }
+    }
+}
+
+// Zonal statistics of all polygons, with vertices of polygon 'i' in
+// lon [offsets [i]:(offsets [i + 1] - 1)] and equivalent 'lat' values.
+// Polygons are split between threads, and results are independent of the
+// number of threads. Polygons which contain no cell centres have mean values
+// of NaN.
+void zonal::polygon_stats (const RasterGrid &grid,
+        const std::vector <double> &lon,
+        const std::vector <double> &lat,
+        const std::vector <index_t> &offsets,
+        const int nthreads,
+        ZonalStats &stats)
+{
+    const size_t n = offsets.size () - 1;
+    stats.mean.resize (n);
+    stats.area_sum.resize (n);
+    stats.count.resize (n);
+
+    threads::parallel_for (n, nthreads,
+            [&] (size_t from, size_t to, size_t) {
+                std::vector <double> crossings;
+                double sum;
+                for (size_t i = from; i < to; i++)
+                {
+                    zonal::scan_polygon (grid, lon.data () + offsets [i],
+                            lat.data () + offsets [i],
+                            offsets [i + 1] - offsets [i], crossings,
+                            sum, stats.area_sum [i], stats.count [i]);
+                    stats.mean [i] = stats.count [i] > 0 ?
+                        sum / static_cast <double> (stats.count [i]) : NAN;
+                }
+            });
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "typedefs.h"
+
+#include <vector>
+
+// A raster grid in geographic coordinates, with values held in column-major
+// order (as in R matrices), and row 0 at the top (northern) edge.
+struct RasterGrid
+{
+    const double *values;
+    size_t nrow;
+    size_t ncol;
+    double xmin;
+    double ymax;
+    double dx;
+    double dy;
+};
+
+// Statistics of all raster cells with centres within each polygon.
+struct ZonalStats
+{
+    std::vector <double> mean;
+    // Sum of values multiplied by cell areas in square kilometres:
+    std::vector <double> area_sum;
+    std::vector <index_t> count;
+};
+
+namespace zonal {
+
+void scan_polygon (const RasterGrid &grid,
+        const double *lon,
+        const double *lat,
+        const size_t n,
+        std::vector <double> &crossings,
+        double &sum,
+        double &area_sum,
+        index_t &count);
+
+void polygon_stats (const RasterGrid &grid,
+        const std::vector <double> &lon,
+        const std::vector <double> &lat,
+        const std::vector <index_t> &offsets,
+        const int nthreads,
+        ZonalStats &stats);
+
+} // end namespace zonal